@@ -0,0 +1,137 @@
+// =========================================================================
+// asyncWriter.h
+// =========================================================================
+#ifndef LCR_ASYNCWRITER_H
+#define LCR_ASYNCWRITER_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <cstring>
+#include <algorithm>
+#include <ostream>
+#include <charconv>
+#include <string_view>
+#include <condition_variable>
+
+// Double-buffered output stream. Text is formatted into the front buffer by the owner while
+// an I/O thread writes the back buffer to the stream; when the front buffer fills up the two
+// are swapped. Formatting only waits for the disk if the previous buffer is still being written.
+class AsyncWriter {
+public:
+    static constexpr size_t BufferBytes = 1 << 20;
+
+    explicit AsyncWriter(std::ostream& out);
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    // Pointer to at least `bytes` free bytes (bytes <= BufferBytes); follow with commit()
+    char* reserve(size_t bytes);
+    // Marks everything up to `end` (from the last reserve()) as written
+    void commit(const char* end) { this->used = static_cast<size_t>(end - this->front.data()); }
+
+    void append(std::string_view text);
+    void append(long long value);
+
+    // Writes out everything appended so far, waits for the I/O thread and flushes the stream
+    void finish();
+
+    // Helpers for formatting into reserved space
+    static char* put(char* at, std::string_view text) {
+        std::memcpy(at, text.data(), text.size());
+        return at + text.size();
+    }
+    static char* put(char* at, long long value) {
+        return std::to_chars(at, at + 20, value).ptr;
+    }
+
+private:
+    // Hands the front buffer to the I/O thread, waiting for it to finish the previous one
+    void swap();
+    void run();
+
+    std::ostream& out;
+    std::vector<char> front;
+    std::vector<char> back;
+    size_t used = 0;     // Bytes of `front` filled
+    size_t pending = 0;  // Bytes of `back` waiting for the I/O thread; 0 when it is idle
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool stopping = false;
+    std::thread ioThread;
+};
+
+inline AsyncWriter::AsyncWriter(std::ostream& out) : out(out), front(BufferBytes), back(BufferBytes) {
+    this->ioThread = std::thread([this] { run(); });
+}
+
+inline AsyncWriter::~AsyncWriter() {
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->changed.notify_all();
+    if (this->ioThread.joinable()) { this->ioThread.join(); }
+}
+
+inline char* AsyncWriter::reserve(size_t bytes) {
+    if (BufferBytes - this->used < bytes) { swap(); }
+    return this->front.data() + this->used;
+}
+
+inline void AsyncWriter::append(std::string_view text) {
+    while (!text.empty()) {
+        size_t take = std::min(text.size(), BufferBytes - this->used);
+        if (take == 0) {
+            swap();
+            continue;
+        }
+        std::memcpy(this->front.data() + this->used, text.data(), take);
+        this->used += take;
+        text.remove_prefix(take);
+    }
+}
+
+inline void AsyncWriter::append(long long value) {
+    commit(put(reserve(20), value));
+}
+
+inline void AsyncWriter::finish() {
+    swap();
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->changed.wait(lock, [this] { return this->pending == 0; });
+    this->out.flush();
+}
+
+inline void AsyncWriter::swap() {
+    if (this->used == 0) return;
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->changed.wait(lock, [this] { return this->pending == 0; });
+    std::swap(this->front, this->back);
+    this->pending = this->used;
+    this->used = 0;
+    lock.unlock();
+    this->changed.notify_all();
+}
+
+inline void AsyncWriter::run() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true) {
+        this->changed.wait(lock, [this] { return this->pending > 0 || this->stopping; });
+        if (this->pending == 0) return; // Stopping with nothing left to write
+
+        // `back` is the I/O thread's until pending is cleared, so write it unlocked
+        size_t bytes = this->pending;
+        lock.unlock();
+        this->out.write(this->back.data(), static_cast<std::streamsize>(bytes));
+        lock.lock();
+        this->pending = 0;
+        this->changed.notify_all();
+    }
+}
+
+#endif //LCR_ASYNCWRITER_H
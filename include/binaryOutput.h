@@ -0,0 +1,302 @@
+// =========================================================================
+// binaryOutput.h
+// =========================================================================
+#ifndef LCR_BINARYOUTPUT_H
+#define LCR_BINARYOUTPUT_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include "json.hpp"
+#include "resultSink.h"
+
+// Columnar binary results file (.lcrb).
+//
+//   "LCRB" | uint32 version | uint32 header length | header JSON (roster, config, encoding)
+//   block*: uint32 record count | uint32 payload bytes | payload
+//
+// A block's payload holds one column after another for up to BlockRecords games:
+//   plain:      int32 gameId[n] | int32 rounds[n] | int16 winnerSeat[n] | uint8 strategy[n] | uint8 draw[n]
+//   compressed: gameId as zigzag varint deltas from the previous id (ids arrive in runs) |
+//               rounds as varints | winnerSeat + 1 as varints | uint8 strategy[n] | draw as a bitset
+// Integers are little-endian. Everything that is constant for the run lives in the header,
+// including runEachSim, from which a reader recovers each record's batch id.
+// The header JSON is padded with spaces so the first block starts on an 8-byte boundary; with
+// plain encoding every column is then aligned and can be used straight from a memory map.
+// Columns are copied to and from host integers as raw bytes, so the host must be little-endian.
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The .lcrb format stores integers little-endian");
+
+class BinaryFormat {
+public:
+    static constexpr char Magic[4] = {'L', 'C', 'R', 'B'};
+    static constexpr uint32_t Version = 1;
+    static constexpr size_t BlockRecords = 65536;
+    static constexpr size_t PreambleBytes = sizeof(Magic) + 2 * sizeof(uint32_t);
+
+    // Throws std::runtime_error unless the file starts with the magic and a known version
+    static void checkPreamble(const char* magic, uint32_t version) {
+        if (std::memcmp(magic, Magic, sizeof(Magic)) != 0) {
+            throw std::runtime_error("Not an LCR binary results file.");
+        }
+        if (version != Version) {
+            throw std::runtime_error("Unsupported results file version " + std::to_string(version) + ".");
+        }
+    }
+
+    static void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Throws std::runtime_error if the varint runs past `end`
+    static uint64_t getVarint(const uint8_t*& in, const uint8_t* end) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (in == end) break;
+            uint8_t byte = *in++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        throw std::runtime_error("Corrupt results block: truncated varint.");
+    }
+
+    static uint64_t zigzag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+    static int64_t unzigzag(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+};
+
+// One block's columns, either pointing into the block's payload or into a BlockBuffer
+struct BlockColumns {
+    size_t count = 0;
+    const int32_t* gameId = nullptr;
+    const int32_t* rounds = nullptr;
+    const int16_t* winnerSeat = nullptr;
+    const uint8_t* winnerStrategy = nullptr;
+    const uint8_t* draw = nullptr;
+};
+
+// Storage for columns that had to be decoded or realigned
+struct BlockBuffer {
+    std::vector<int32_t> gameId;
+    std::vector<int32_t> rounds;
+    std::vector<int16_t> winnerSeat;
+    std::vector<uint8_t> winnerStrategy;
+    std::vector<uint8_t> draw;
+
+    // Decodes a block's payload. Plain, aligned payloads are used in place; anything else is
+    // decoded into `buffer`. Throws std::runtime_error on a corrupt block.
+    static BlockColumns decode(const uint8_t* payload, size_t size, uint32_t count, bool compressed, BlockBuffer& buffer);
+
+private:
+    void resize(size_t count);
+    BlockColumns columns(size_t count) const {
+        return BlockColumns{count, this->gameId.data(), this->rounds.data(), this->winnerSeat.data(),
+                            this->winnerStrategy.data(), this->draw.data()};
+    }
+};
+
+// Buffers streamed records into column blocks and writes each block with one write
+class BinaryRecordWriter : public RecordWriter {
+public:
+    // `header` describes the run (see Output's binary header); the encoding is added to it
+    BinaryRecordWriter(std::ostream& out, nlohmann::json header, bool compress);
+
+    void write(int worker, const GameRecord* records, size_t count) override;
+    void finish() override;
+
+private:
+    void flushBlock();
+
+    std::ostream& out;
+    bool compress;
+    std::vector<GameRecord> pending;
+    std::vector<uint8_t> payload;
+};
+
+// Reads a .lcrb file block by block
+class BinaryResultReader {
+public:
+    // Reads and checks the file header; throws std::runtime_error on a bad file
+    explicit BinaryResultReader(std::istream& in);
+
+    const nlohmann::json& header() const { return this->headerData; }
+
+    // Replaces `records` with the next block's; returns false at the end of the file
+    bool nextBlock(std::vector<GameRecord>& records);
+
+private:
+    std::istream& in;
+    nlohmann::json headerData;
+    bool compressed;
+    int gamesPerBatch;
+    std::vector<uint8_t> payload;
+    BlockBuffer buffer;
+};
+
+inline void BlockBuffer::resize(size_t count) {
+    this->gameId.resize(count);
+    this->rounds.resize(count);
+    this->winnerSeat.resize(count);
+    this->winnerStrategy.resize(count);
+    this->draw.resize(count);
+}
+
+inline BlockColumns BlockBuffer::decode(const uint8_t* payload, size_t size, uint32_t count, bool compressed, BlockBuffer& buffer) {
+    const uint8_t* p = payload;
+    const uint8_t* end = payload + size;
+    auto need = [&](size_t bytes) {
+        if (static_cast<size_t>(end - p) < bytes) throw std::runtime_error("Corrupt results block: payload too short.");
+    };
+
+    if (!compressed) {
+        need(static_cast<size_t>(count) * 12);
+        if (reinterpret_cast<uintptr_t>(payload) % alignof(int32_t) == 0) {
+            BlockColumns view;
+            view.count = count;
+            view.gameId = reinterpret_cast<const int32_t*>(p);
+            view.rounds = reinterpret_cast<const int32_t*>(p + 4 * static_cast<size_t>(count));
+            view.winnerSeat = reinterpret_cast<const int16_t*>(p + 8 * static_cast<size_t>(count));
+            view.winnerStrategy = p + 10 * static_cast<size_t>(count);
+            view.draw = p + 11 * static_cast<size_t>(count);
+            return view;
+        }
+        buffer.resize(count);
+        std::memcpy(buffer.gameId.data(), p, 4 * static_cast<size_t>(count));
+        std::memcpy(buffer.rounds.data(), p + 4 * static_cast<size_t>(count), 4 * static_cast<size_t>(count));
+        std::memcpy(buffer.winnerSeat.data(), p + 8 * static_cast<size_t>(count), 2 * static_cast<size_t>(count));
+        std::memcpy(buffer.winnerStrategy.data(), p + 10 * static_cast<size_t>(count), count);
+        std::memcpy(buffer.draw.data(), p + 11 * static_cast<size_t>(count), count);
+        return buffer.columns(count);
+    }
+
+    buffer.resize(count);
+    int64_t previous = 0;
+    for (uint32_t k = 0; k < count; ++k) {
+        previous += BinaryFormat::unzigzag(BinaryFormat::getVarint(p, end));
+        buffer.gameId[k] = static_cast<int32_t>(previous);
+    }
+    for (uint32_t k = 0; k < count; ++k) { buffer.rounds[k] = static_cast<int32_t>(BinaryFormat::getVarint(p, end)); }
+    for (uint32_t k = 0; k < count; ++k) { buffer.winnerSeat[k] = static_cast<int16_t>(static_cast<int64_t>(BinaryFormat::getVarint(p, end)) - 1); }
+    need(count + (count + 7) / 8);
+    std::memcpy(buffer.winnerStrategy.data(), p, count);
+    p += count;
+    for (uint32_t k = 0; k < count; ++k) { buffer.draw[k] = (p[k / 8] >> (k % 8)) & 1; }
+    return buffer.columns(count);
+}
+
+inline BinaryRecordWriter::BinaryRecordWriter(std::ostream& out, nlohmann::json header, bool compress)
+        : out(out), compress(compress) {
+    header["encoding"] = compress ? "varint" : "plain";
+    std::string text = header.dump();
+    text.append((8 - (BinaryFormat::PreambleBytes + text.size()) % 8) % 8, ' ');
+    const uint32_t version = BinaryFormat::Version;
+    const uint32_t length = static_cast<uint32_t>(text.size());
+    this->out.write(BinaryFormat::Magic, sizeof(BinaryFormat::Magic));
+    this->out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    this->out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    this->out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    this->pending.reserve(BinaryFormat::BlockRecords);
+}
+
+inline void BinaryRecordWriter::write(int, const GameRecord* records, size_t count) {
+    while (count > 0) {
+        size_t take = std::min(count, BinaryFormat::BlockRecords - this->pending.size());
+        this->pending.insert(this->pending.end(), records, records + take);
+        records += take;
+        count -= take;
+        if (this->pending.size() == BinaryFormat::BlockRecords) { flushBlock(); }
+    }
+}
+
+inline void BinaryRecordWriter::finish() {
+    flushBlock();
+    this->out.flush();
+}
+
+inline void BinaryRecordWriter::flushBlock() {
+    const size_t n = this->pending.size();
+    if (n == 0) return;
+
+    std::vector<uint8_t>& bytes = this->payload;
+    bytes.clear();
+    auto append = [&](const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), p, p + size);
+    };
+
+    if (this->compress) {
+        int64_t previous = 0;
+        for (const GameRecord& r : this->pending) {
+            BinaryFormat::putVarint(bytes, BinaryFormat::zigzag(static_cast<int64_t>(r.gameId) - previous));
+            previous = r.gameId;
+        }
+        for (const GameRecord& r : this->pending) { BinaryFormat::putVarint(bytes, static_cast<uint32_t>(r.rounds)); }
+        for (const GameRecord& r : this->pending) { BinaryFormat::putVarint(bytes, static_cast<uint64_t>(r.winnerSeat + 1)); }
+        for (const GameRecord& r : this->pending) { bytes.push_back(r.winnerStrategy); }
+        size_t bitsAt = bytes.size();
+        bytes.resize(bitsAt + (n + 7) / 8, 0);
+        for (size_t k = 0; k < n; ++k) {
+            if (this->pending[k].draw) { bytes[bitsAt + k / 8] |= static_cast<uint8_t>(1u << (k % 8)); }
+        }
+    } else {
+        bytes.reserve(n * 12);
+        for (const GameRecord& r : this->pending) { append(&r.gameId, sizeof(r.gameId)); }
+        for (const GameRecord& r : this->pending) { append(&r.rounds, sizeof(r.rounds)); }
+        for (const GameRecord& r : this->pending) { append(&r.winnerSeat, sizeof(r.winnerSeat)); }
+        for (const GameRecord& r : this->pending) { bytes.push_back(r.winnerStrategy); }
+        for (const GameRecord& r : this->pending) { bytes.push_back(r.draw); }
+    }
+
+    const uint32_t count = static_cast<uint32_t>(n);
+    const uint32_t size = static_cast<uint32_t>(bytes.size());
+    this->out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    this->out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    this->out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    this->pending.clear();
+}
+
+inline BinaryResultReader::BinaryResultReader(std::istream& in) : in(in), compressed(false), gamesPerBatch(1) {
+    char magic[sizeof(BinaryFormat::Magic)];
+    uint32_t version = 0;
+    uint32_t length = 0;
+    this->in.read(magic, sizeof(magic));
+    this->in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    this->in.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!this->in) throw std::runtime_error("Not an LCR binary results file.");
+    BinaryFormat::checkPreamble(magic, version);
+
+    std::string text(length, '\0');
+    this->in.read(text.data(), length);
+    if (!this->in) throw std::runtime_error("Truncated results file header.");
+    this->headerData = nlohmann::json::parse(text);
+    this->compressed = this->headerData.value("encoding", "plain") == "varint";
+    this->gamesPerBatch = std::max(1, this->headerData.value("runEachSim", 1));
+}
+
+inline bool BinaryResultReader::nextBlock(std::vector<GameRecord>& records) {
+    uint32_t count = 0;
+    uint32_t size = 0;
+    this->in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (this->in.gcount() == 0) return false;
+    this->in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    this->payload.resize(size);
+    this->in.read(reinterpret_cast<char*>(this->payload.data()), size);
+    if (!this->in) throw std::runtime_error("Truncated results block.");
+
+    const BlockColumns columns = BlockBuffer::decode(this->payload.data(), size, count, this->compressed, this->buffer);
+    records.resize(count);
+    for (uint32_t k = 0; k < count; ++k) {
+        records[k] = GameRecord{columns.gameId[k], columns.gameId[k] / this->gamesPerBatch, columns.rounds[k],
+                                columns.winnerSeat[k], columns.winnerStrategy[k], columns.draw[k]};
+    }
+    return true;
+}
+
+#endif //LCR_BINARYOUTPUT_H
@@ -0,0 +1,226 @@
+// =========================================================================
+// checkpoint.h
+// =========================================================================
+#ifndef LCR_CHECKPOINT_H
+#define LCR_CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <fstream>
+#include <optional>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+#include "json.hpp"
+#include "tally.h"
+#include "lengthHistogram.h"
+#include "roundStats.h"
+
+// A run's merged aggregates and the game ids they cover, saved so an interrupted run can carry
+// on where it stopped, and written by every shard of a sharded run for `lcr merge`. Every game
+// draws from its own Rng(seed, gameId) stream and its batch's deal, so the completed ranges are
+// all the stream state there is: playing the missing ids, or merging the shards, and adding
+// their counts gives the same totals as one uninterrupted run.
+class Checkpoint {
+public:
+    static constexpr int Version = 1;
+
+    // Game ids [first, second)
+    using Range = std::pair<int64_t, int64_t>;
+
+    nlohmann::json run;              // The run's description, seed included
+    std::vector<Range> completed;    // Sorted, disjoint and coalesced
+    Tally::Totals tally;
+    std::vector<LengthHistogram::Series> lengths;
+    std::optional<RoundStats::Totals> rounds;
+    bool lengthHistogram = false;    // Whether the run exports its histogram, for `lcr merge`
+    std::optional<std::pair<int, int>> shard; // Index and count, for a shard's partial file
+
+    // FNV-1a of the description, as 16 hex digits
+    static std::string runHash(const nlohmann::json& run);
+
+    uint64_t gamesCompleted() const;
+
+    // The parts of [begin, end) not completed yet, in order
+    std::vector<Range> missing(int64_t begin, int64_t end) const;
+
+    // Adds ranges of finished games (in any order) to `completed`
+    void addCompleted(std::vector<Range> ranges);
+
+    // Adds another part of the same run; throws std::invalid_argument if it is from a different
+    // run or shares games with this one
+    void merge(const Checkpoint& other);
+
+    // Writes to a temporary file and renames it over `path`, so a crash mid-write leaves the
+    // previous checkpoint intact. Throws std::runtime_error if the file cannot be written.
+    void save(const std::string& path) const;
+
+    // Throws std::runtime_error if the file is missing, unreadable or from another version
+    static Checkpoint load(const std::string& path);
+};
+
+inline std::string Checkpoint::runHash(const nlohmann::json& run) {
+    const std::string text = run.dump();
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : text) { hash = (hash ^ c) * 0x100000001b3ULL; }
+    std::ostringstream hex;
+    hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return hex.str();
+}
+
+inline uint64_t Checkpoint::gamesCompleted() const {
+    uint64_t games = 0;
+    for (const Range& range : this->completed) { games += static_cast<uint64_t>(range.second - range.first); }
+    return games;
+}
+
+inline std::vector<Checkpoint::Range> Checkpoint::missing(int64_t begin, int64_t end) const {
+    std::vector<Range> gaps;
+    int64_t from = begin;
+    for (const Range& range : this->completed) {
+        if (range.second <= from) continue;
+        if (range.first > from) gaps.emplace_back(from, std::min(range.first, end));
+        from = std::max(from, range.second);
+        if (from >= end) break;
+    }
+    if (from < end) gaps.emplace_back(from, end);
+    return gaps;
+}
+
+inline void Checkpoint::addCompleted(std::vector<Range> ranges) {
+    ranges.insert(ranges.end(), this->completed.begin(), this->completed.end());
+    std::sort(ranges.begin(), ranges.end());
+    this->completed.clear();
+    for (const Range& range : ranges) {
+        if (range.first >= range.second) continue;
+        if (!this->completed.empty() && range.first <= this->completed.back().second) {
+            this->completed.back().second = std::max(this->completed.back().second, range.second);
+        } else {
+            this->completed.push_back(range);
+        }
+    }
+}
+
+inline void Checkpoint::merge(const Checkpoint& other) {
+    if (runHash(other.run) != runHash(this->run)) {
+        throw std::invalid_argument("Partial results are from different runs");
+    }
+    for (size_t a = 0, b = 0; a < this->completed.size() && b < other.completed.size();) {
+        const Range& mine = this->completed[a];
+        const Range& theirs = other.completed[b];
+        if (mine.first < theirs.second && theirs.first < mine.second) {
+            throw std::invalid_argument("Partial results overlap at game " + std::to_string(std::max(mine.first, theirs.first)));
+        }
+        if (mine.second <= theirs.second) a++; else b++;
+    }
+    if (this->rounds.has_value() != other.rounds.has_value()) {
+        throw std::invalid_argument("Partial results disagree on roundHeatmap");
+    }
+
+    addCompleted(other.completed);
+    this->tally.games += other.tally.games;
+    this->tally.draws += other.tally.draws;
+    for (int strategy = 0; strategy < Tally::NumStrategies; ++strategy) { this->tally.strategyWins[strategy] += other.tally.strategyWins[strategy]; }
+    this->tally.seatWins.resize(std::max(this->tally.seatWins.size(), other.tally.seatWins.size()), 0);
+    for (size_t seat = 0; seat < other.tally.seatWins.size(); ++seat) { this->tally.seatWins[seat] += other.tally.seatWins[seat]; }
+    this->lengths.resize(LengthHistogram::Groups);
+    for (size_t group = 0; group < other.lengths.size() && group < this->lengths.size(); ++group) { this->lengths[group].add(other.lengths[group]); }
+    if (this->rounds) {
+        for (size_t k = 0; k < this->rounds->games.size(); ++k) { this->rounds->games[k] += other.rounds->games[k]; }
+        for (size_t k = 0; k < this->rounds->sums.size(); ++k) {
+            this->rounds->sums[k] += other.rounds->sums[k];
+            this->rounds->squares[k] += other.rounds->squares[k];
+        }
+    }
+    this->lengthHistogram = this->lengthHistogram || other.lengthHistogram;
+    this->shard.reset();
+}
+
+inline void Checkpoint::save(const std::string& path) const {
+    nlohmann::json lengthGroups = nlohmann::json::array();
+    for (const LengthHistogram::Series& series : this->lengths) {
+        lengthGroups.push_back({{"counts", series.counts}, {"longest", series.longest}});
+    }
+    nlohmann::json data = {
+            {"version", Version},
+            {"runHash", runHash(this->run)},
+            {"run", this->run},
+            {"completed", this->completed},
+            {"games", this->tally.games},
+            {"draws", this->tally.draws},
+            {"strategyWins", this->tally.strategyWins},
+            {"seatWins", this->tally.seatWins},
+            {"lengths", lengthGroups},
+            {"lengthHistogram", this->lengthHistogram}
+    };
+    if (this->shard) {
+        data["shard"] = {{"index", this->shard->first}, {"count", this->shard->second}};
+    }
+    if (this->rounds) {
+        data["rounds"] = {{"games", this->rounds->games}, {"sums", this->rounds->sums}, {"squares", this->rounds->squares}};
+    }
+
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        out << data.dump();
+        out.close();
+        if (out.fail()) throw std::runtime_error("Could not write checkpoint " + tmpPath);
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) throw std::runtime_error("Could not replace checkpoint " + path + ": " + ec.message());
+}
+
+inline Checkpoint Checkpoint::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::runtime_error("Could not open " + path);
+
+    Checkpoint checkpoint;
+    try {
+        nlohmann::json data;
+        in >> data;
+        if (data.at("version").get<int>() != Version) throw std::runtime_error("unsupported version");
+        checkpoint.run = data.at("run");
+        if (data.at("runHash").get<std::string>() != runHash(checkpoint.run)) throw std::runtime_error("run description does not match its hash");
+        checkpoint.addCompleted(data.at("completed").get<std::vector<Range>>());
+        checkpoint.tally.games = data.at("games").get<uint64_t>();
+        checkpoint.tally.draws = data.at("draws").get<uint64_t>();
+        const std::vector<uint64_t> strategyWins = data.at("strategyWins").get<std::vector<uint64_t>>();
+        if (strategyWins.size() != Tally::NumStrategies) throw std::runtime_error("wrong number of strategies");
+        std::copy(strategyWins.begin(), strategyWins.end(), checkpoint.tally.strategyWins);
+        checkpoint.tally.seatWins = data.at("seatWins").get<std::vector<uint64_t>>();
+
+        const nlohmann::json& lengthGroups = data.at("lengths");
+        if (lengthGroups.size() != LengthHistogram::Groups) throw std::runtime_error("wrong number of length groups");
+        for (const nlohmann::json& group : lengthGroups) {
+            LengthHistogram::Series series;
+            series.counts = group.at("counts").get<std::vector<uint64_t>>();
+            if (series.counts.size() != LengthHistogram::Buckets) throw std::runtime_error("wrong number of length buckets");
+            for (uint64_t count : series.counts) { series.games += count; }
+            series.longest = group.at("longest").get<int>();
+            checkpoint.lengths.push_back(std::move(series));
+        }
+
+        if (data.contains("rounds")) {
+            RoundStats::Totals rounds;
+            rounds.games = data.at("rounds").at("games").get<std::vector<uint64_t>>();
+            rounds.sums = data.at("rounds").at("sums").get<std::vector<uint64_t>>();
+            rounds.squares = data.at("rounds").at("squares").get<std::vector<uint64_t>>();
+            checkpoint.rounds = std::move(rounds);
+        }
+        checkpoint.lengthHistogram = data.value("lengthHistogram", false);
+        if (data.contains("shard")) {
+            checkpoint.shard = std::make_pair(data.at("shard").at("index").get<int>(), data.at("shard").at("count").get<int>());
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Error reading " + path + ": " + e.what());
+    }
+    return checkpoint;
+}
+
+#endif //LCR_CHECKPOINT_H
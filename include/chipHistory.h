@@ -0,0 +1,175 @@
+// =========================================================================
+// chipHistory.h
+// =========================================================================
+#ifndef LCR_CHIPHISTORY_H
+#define LCR_CHIPHISTORY_H
+
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include "gameState.h"
+#include "resultSink.h"
+#include "binaryOutput.h"
+
+// Which games get a chip history. A game is recorded if its id is a multiple of `every`, or
+// if any of the outcome filters is set and the game matches all of them. Both rules only look
+// at the finished game's record, so the output stage can tell which games have a history.
+struct HistorySampler {
+    int every = 0;                  // 0 disables periodic sampling
+    std::optional<bool> draw;
+    std::optional<int> minRounds;
+    std::optional<int> maxRounds;
+    std::optional<int> winnerSeat;  // 0-based
+
+    bool enabled() const { return this->every > 0 || hasFilter(); }
+    bool hasFilter() const { return this->draw || this->minRounds || this->maxRounds || this->winnerSeat; }
+
+    bool selects(const GameRecord& record) const {
+        if (this->every > 0 && record.gameId % this->every == 0) return true;
+        if (!hasFilter()) return false;
+        return (!this->draw || *this->draw == static_cast<bool>(record.draw)) &&
+               (!this->minRounds || record.rounds >= *this->minRounds) &&
+               (!this->maxRounds || record.rounds <= *this->maxRounds) &&
+               (!this->winnerSeat || record.winnerSeat == *this->winnerSeat);
+    }
+};
+
+// Records one game's chips as a byte stream: the seat count and starting chips, then for
+// every turn the seats whose chips changed, each as a varint seat gap and a zigzag varint
+// chip delta. A typical turn moves one to three chips and takes a handful of bytes.
+class ChipRecorder {
+public:
+    void begin(const GameState& state);
+    void turn(const GameState& state);
+
+    const std::vector<uint8_t>& bytes() const { return this->stream; }
+
+    // Chips at the deal and after every turn
+    static std::vector<std::vector<int>> decode(const uint8_t* bytes, size_t size);
+
+private:
+    std::vector<int> last;
+    std::vector<uint8_t> stream;
+    std::vector<int> changed;
+};
+
+// Chip histories of the sampled games, kept in one byte arena per worker until the output
+// stage has written them. A worker's records reach the output stage in the order it played
+// them, so each arena is a queue: the worker appends at the back, the output stage takes from
+// the front, and the written front is reclaimed as it goes. Both ends are used while the run
+// is going, which is why each arena has a lock. Only sampled games ever touch it.
+class ChipHistoryStore {
+public:
+    ChipHistoryStore(int numWorkers, const HistorySampler& sampler);
+
+    const HistorySampler& sampler() const { return this->sampling; }
+
+    void add(int worker, int gameId, const ChipRecorder& recorder);
+
+    // Chips at the deal and after every turn of `gameId`, which must be the oldest game
+    // `worker` recorded and nobody has taken yet; empty if it was not recorded
+    std::vector<std::vector<int>> take(int worker, int gameId);
+
+private:
+    struct Entry {
+        int gameId;
+        size_t offset;
+        size_t length;
+    };
+
+    struct alignas(64) Arena {
+        std::mutex mutex;
+        std::vector<uint8_t> bytes;
+        std::deque<Entry> games; // Oldest first
+    };
+
+    HistorySampler sampling;
+    std::vector<std::unique_ptr<Arena>> arenas;
+};
+
+inline void ChipRecorder::begin(const GameState& state) {
+    const int numSeats = state.getNumSeats();
+    this->stream.clear();
+    this->last.resize(numSeats);
+    BinaryFormat::putVarint(this->stream, static_cast<uint64_t>(numSeats));
+    for (int seat = 0; seat < numSeats; ++seat) {
+        this->last[seat] = state.getChips(seat);
+        BinaryFormat::putVarint(this->stream, static_cast<uint64_t>(this->last[seat]));
+    }
+}
+
+inline void ChipRecorder::turn(const GameState& state) {
+    this->changed.clear();
+    for (int seat = 0; seat < static_cast<int>(this->last.size()); ++seat) {
+        if (state.getChips(seat) != this->last[seat]) { this->changed.push_back(seat); }
+    }
+    BinaryFormat::putVarint(this->stream, this->changed.size());
+    int previous = 0;
+    for (int seat : this->changed) {
+        const int chips = state.getChips(seat);
+        BinaryFormat::putVarint(this->stream, static_cast<uint64_t>(seat - previous));
+        BinaryFormat::putVarint(this->stream, BinaryFormat::zigzag(chips - this->last[seat]));
+        this->last[seat] = chips;
+        previous = seat;
+    }
+}
+
+inline std::vector<std::vector<int>> ChipRecorder::decode(const uint8_t* bytes, size_t size) {
+    const uint8_t* p = bytes;
+    const uint8_t* end = bytes + size;
+    std::vector<std::vector<int>> snapshots;
+    if (size == 0) return snapshots;
+
+    std::vector<int> chips(BinaryFormat::getVarint(p, end));
+    for (int& seatChips : chips) { seatChips = static_cast<int>(BinaryFormat::getVarint(p, end)); }
+    snapshots.push_back(chips);
+    while (p < end) {
+        uint64_t count = BinaryFormat::getVarint(p, end);
+        size_t seat = 0;
+        for (uint64_t k = 0; k < count; ++k) {
+            seat += BinaryFormat::getVarint(p, end);
+            if (seat >= chips.size()) throw std::runtime_error("Corrupt chip history.");
+            chips[seat] += static_cast<int>(BinaryFormat::unzigzag(BinaryFormat::getVarint(p, end)));
+        }
+        snapshots.push_back(chips);
+    }
+    return snapshots;
+}
+
+inline ChipHistoryStore::ChipHistoryStore(int numWorkers, const HistorySampler& sampler) : sampling(sampler) {
+    for (int worker = 0; worker < numWorkers; ++worker) {
+        this->arenas.push_back(std::make_unique<Arena>());
+    }
+}
+
+inline void ChipHistoryStore::add(int worker, int gameId, const ChipRecorder& recorder) {
+    Arena& arena = *this->arenas[worker];
+    const std::vector<uint8_t>& bytes = recorder.bytes();
+    std::lock_guard<std::mutex> lock(arena.mutex);
+    arena.games.push_back(Entry{gameId, arena.bytes.size(), bytes.size()});
+    arena.bytes.insert(arena.bytes.end(), bytes.begin(), bytes.end());
+}
+
+inline std::vector<std::vector<int>> ChipHistoryStore::take(int worker, int gameId) {
+    Arena& arena = *this->arenas[worker];
+    std::lock_guard<std::mutex> lock(arena.mutex);
+    if (arena.games.empty() || arena.games.front().gameId != gameId) return {};
+    const Entry entry = arena.games.front();
+    arena.games.pop_front();
+    std::vector<std::vector<int>> snapshots = ChipRecorder::decode(arena.bytes.data() + entry.offset, entry.length);
+
+    // Drop the written front once it is at least half the arena, so each byte moves at most once on average
+    const size_t written = entry.offset + entry.length;
+    if (arena.games.empty()) {
+        arena.bytes.clear();
+    } else if (written >= arena.bytes.size() / 2) {
+        arena.bytes.erase(arena.bytes.begin(), arena.bytes.begin() + static_cast<std::ptrdiff_t>(written));
+        for (Entry& pending : arena.games) { pending.offset -= written; }
+    }
+    return snapshots;
+}
+
+#endif //LCR_CHIPHISTORY_H
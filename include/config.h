@@ -0,0 +1,187 @@
+// =========================================================================
+// config.h
+// =========================================================================
+#ifndef LCR_CONFIG_H
+#define LCR_CONFIG_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include "json.hpp"
+#include "player.h"
+#include "output.h"
+#include "chipHistory.h"
+#include "precision.h"
+#include "sweep.h"
+
+// Simulation parameters, read from the JSON config file or the built-in defaults
+class Config {
+public:
+    // Which game loop plays the simulations. Both give identical results for a seed.
+    enum class Engine {
+        Generic,     // Game::play on any table size
+        Specialized, // Kernels::play: compile-time kernels for 2-16 seats, generic otherwise
+        Lockstep,    // LockstepEngine: several games per worker stepped together in vector lanes
+    };
+
+    int numSimulations = 10'000;    // With a precision target, numSimulations * runEachSim caps the run
+    int startingPlayer = -1;        // 1-based; negative picks a random starter for every batch
+    Output::OutputType outputType = Output::OutputType::Totals;
+    int runEachSim = 100;
+    std::optional<uint64_t> seed;   // Drawn from std::random_device when not configured
+    Engine engine = Engine::Specialized;
+    bool compressOutput = false;    // Delta/varint-encode Binary output blocks
+    bool jsonOutput = false;        // Also write every game to lcr_simulation_results.json
+    HistorySampler history;         // Games whose chip history goes into the JSON output
+    bool roundHeatmap = false;      // Write mean chips per seat per round to lcr_round_heatmap.json
+    bool lengthHistogram = false;   // Write the game-length histogram buckets to lcr_length_histogram.csv
+    std::optional<Precision::Target> precision; // Stop once every win rate's interval is this narrow
+    std::optional<double> maxSeconds; // Stop playing new games after this long; finished games are still reported
+    std::optional<double> checkpointSeconds; // Save progress to lcr_checkpoint.json this often (Totals output only)
+    std::optional<Sweep::Grid> sweep; // Play every combination of these table variations instead
+    std::vector<Player> players;
+
+    // Reads a config file; throws std::runtime_error if it cannot be opened or parsed
+    static Config load(const std::string& path);
+
+    // Ten players with 3 chips each and random strategies
+    static Config defaults();
+
+    // "generic", "specialized" or "lockstep"; throws std::invalid_argument otherwise
+    static Engine stringToEngine(const std::string& str);
+
+    // A strategy as written in the config: 1-based, or -1 for a random one per batch
+    static Player::PlayStyle configToPlayStyle(int strategy);
+};
+
+inline Config Config::load(const std::string& path) {
+    std::ifstream jsonFile(path);
+    if (!jsonFile.is_open()) {
+        throw std::runtime_error("Error opening JSON file: " + path);
+    }
+
+    Config config;
+    try {
+        nlohmann::json configData;
+        jsonFile >> configData;
+
+        config.numSimulations = configData.at("numSimulations").get<int>();
+        config.startingPlayer = configData.at("startingPlayer").get<int>();
+        config.outputType = Output::stringToOutputType(configData.at("outputType").get<std::string>());
+        config.runEachSim = configData.at("runEachSim").get<int>();
+
+        if (configData.contains("seed")) {
+            config.seed = configData.at("seed").get<uint64_t>();
+        }
+        if (configData.contains("compressOutput")) {
+            config.compressOutput = configData.at("compressOutput").get<bool>();
+        }
+        if (configData.contains("jsonOutput")) {
+            config.jsonOutput = configData.at("jsonOutput").get<bool>();
+        }
+        if (configData.contains("lengthHistogram")) {
+            config.lengthHistogram = configData.at("lengthHistogram").get<bool>();
+        }
+        if (configData.contains("roundHeatmap")) {
+            config.roundHeatmap = configData.at("roundHeatmap").get<bool>();
+        }
+        if (configData.contains("recordHistory")) {
+            // {"every": K} and / or outcome filters: "draw", "minRounds", "maxRounds", "winnerSeat" (1-based)
+            const nlohmann::json& history = configData.at("recordHistory");
+            config.history.every = history.value("every", 0);
+            if (history.contains("draw")) config.history.draw = history.at("draw").get<bool>();
+            if (history.contains("minRounds")) config.history.minRounds = history.at("minRounds").get<int>();
+            if (history.contains("maxRounds")) config.history.maxRounds = history.at("maxRounds").get<int>();
+            if (history.contains("winnerSeat")) config.history.winnerSeat = history.at("winnerSeat").get<int>() - 1;
+        }
+        if (configData.contains("precision")) {
+            // {"halfWidth": 0.002, "confidence": 0.95}
+            const nlohmann::json& precision = configData.at("precision");
+            Precision::Target target;
+            target.halfWidth = precision.at("halfWidth").get<double>();
+            target.confidence = precision.value("confidence", target.confidence);
+            config.precision = target;
+        }
+        if (configData.contains("maxSeconds")) {
+            config.maxSeconds = configData.at("maxSeconds").get<double>();
+        }
+        if (configData.contains("checkpointSeconds")) {
+            config.checkpointSeconds = configData.at("checkpointSeconds").get<double>();
+        }
+        if (configData.contains("sweep")) {
+            // {"totalPlayers": [4, 6], "chips": [3, 5], "strategies": [1, -1, [1, 3]], "startingPlayer": [1, -1]},
+            // a strategy list is per seat, repeated around the table
+            const nlohmann::json& sweep = configData.at("sweep");
+            Sweep::Grid grid;
+            grid.totalPlayers = sweep.value("totalPlayers", std::vector<int>{});
+            grid.chips = sweep.value("chips", std::vector<int>{});
+            grid.startingPlayers = sweep.value("startingPlayer", std::vector<int>{});
+            for (const nlohmann::json& assignment : sweep.value("strategies", nlohmann::json::array())) {
+                std::vector<Player::PlayStyle> seats;
+                for (int strategy : assignment.is_array() ? assignment.get<std::vector<int>>() : std::vector<int>{assignment.get<int>()}) {
+                    seats.push_back(configToPlayStyle(strategy));
+                }
+                grid.strategies.push_back(seats);
+            }
+            config.sweep = grid;
+        }
+        if (configData.contains("engine")) {
+            config.engine = stringToEngine(configData.at("engine").get<std::string>());
+        }
+
+        int totalPlayers = configData.at("totalPlayers").get<int>();
+
+        // Read the players array. Seats hold their chips as uint16_t, so each seat and the
+        // whole table are limited to Roster::MaxChips.
+        int index = 0;
+        int64_t totalChips = 0;
+        for (const auto& player : configData.at("players")) {
+            std::string name = player.at("name").get<std::string>();
+            int chips = player.at("chips").get<int>();
+            if (chips < 0 || chips > Roster::MaxChips) {
+                throw std::invalid_argument("chips of " + name + " must be between 0 and " + std::to_string(Roster::MaxChips));
+            }
+            totalChips += chips;
+            Player::PlayStyle strategy = configToPlayStyle(player.at("strategy").get<int>());
+
+            config.players.emplace_back(name, chips, index, strategy, totalPlayers);
+
+            index++;
+        }
+        if (totalChips > Roster::MaxChips) {
+            throw std::invalid_argument("the players hold " + std::to_string(totalChips) + " chips in all; a table holds at most " +
+                                        std::to_string(Roster::MaxChips));
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error(std::string("Error parsing JSON file: ") + e.what());
+    }
+
+    return config;
+}
+
+inline Config Config::defaults() {
+    Config config;
+    for (int i = 0; i < 10; ++i) {
+        config.players.emplace_back("Player " + std::to_string(i + 1), 3, i, Player::Random, 10);
+    }
+    return config;
+}
+
+inline Config::Engine Config::stringToEngine(const std::string& str) {
+    if (str == "generic") return Engine::Generic;
+    if (str == "specialized") return Engine::Specialized;
+    if (str == "lockstep") return Engine::Lockstep;
+    throw std::invalid_argument("Unknown engine: " + str);
+}
+
+inline Player::PlayStyle Config::configToPlayStyle(int strategy) {
+    if (strategy == -1) return Player::PlayStyle::Random;
+    if (strategy < 1 || strategy > Player::PlayStyle::StealOppositeConditional + 1) {
+        throw std::invalid_argument("Unknown strategy: " + std::to_string(strategy));
+    }
+    return static_cast<Player::PlayStyle>(strategy - 1);
+}
+
+#endif //LCR_CONFIG_H
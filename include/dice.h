@@ -4,13 +4,17 @@
 #ifndef LCR_DICE_H
 #define LCR_DICE_H
 
-#include <random> // Required for random number generation
+#include <cstdint>
+#include <string>
+#include <map>
+#include <vector>
+#include "rng.h"
 
 // Represents the special LCR dice
 class Dice {
 public:
     // Enum representing the possible outcomes of a dice roll
-    enum Side {
+    enum Side : uint8_t {
         L,    // Pass chip to the Left
         C,    // Put chip in the Center (pot)
         R,    // Pass chip to the Right
@@ -18,30 +22,44 @@ public:
         Wild  // Steal or Cancel chip according to player strategy - Appears on 1 side
     };
 
-    // Simulates rolling a single LCR die
-    static Side roll() {
-        // Use a static generator for better performance and randomness distribution
-        static std::random_device dev;
-        static std::mt19937 rng(dev());
-        // Distribution for a 6-sided die (1 to 6)
-        static std::uniform_int_distribution<int> dist(1, 6);
-
-        int rollValue = dist(rng);
-
-        // Map the numerical roll to the corresponding Side enum value
+    // Simulates rolling a single LCR die using the caller's generator
+    static Side roll(Rng& rng) {
+        // Map a uniform 0..5 value to the corresponding Side enum value
         // 1 L, 1 C, 1 R, 1 Wild, 2 Dots
-        switch (rollValue) {
-            case 1: return Side::L;
-            case 2: return Side::C;
-            case 3: return Side::R;
-            case 4: return Side::Wild; // One Wild side
-            case 5: return Side::Dot;  // Two Dot sides
-            case 6: return Side::Dot;
+        switch (rng.below(6)) {
+            case 0: return Side::L;
+            case 1: return Side::C;
+            case 2: return Side::R;
+            case 3: return Side::Wild; // One Wild side
+            case 4: return Side::Dot;  // Two Dot sides
+            case 5: return Side::Dot;
             default: // Should not happen
                 return Side::Dot;
         }
     }
 
+    // Largest number of dice rolled in a single turn
+    static constexpr int MaxDicePerTurn = 3;
+    static constexpr uint16_t DotsOrWildsFlag = 1u << 15;
+
+    // Outcome of a whole turn's roll. Only the multiset of faces matters to the rules, so
+    // this holds a 2-bit count per face (in Side order) plus a flag set when no L, C or R
+    // came up, which is the last player's winning condition.
+    struct Roll {
+        uint16_t packed;
+
+        int count(Side side) const { return (this->packed >> (2 * side)) & 3; }
+        bool onlyDotsOrWilds() const { return (this->packed & DotsOrWildsFlag) != 0; }
+    };
+
+    // Every distinct outcome of rolling numDice dice, keyed by Roll::packed, with the number
+    // of the 6^numDice face sequences that produce it
+    static std::map<uint16_t, uint32_t> outcomeWeights(int numDice);
+
+    // Samples the outcome of rolling numDice (1 to MaxDicePerTurn) dice from one random
+    // word using a precomputed alias table over the 5, 15 or 35 distinct outcomes
+    static Roll rollTurn(int numDice, uint64_t word);
+
     static std::string sideToString(Side side) {
         switch (side) {
             case L: return "L";
@@ -52,6 +70,94 @@ public:
             default: return "Unknown";
         }
     }
+
+private:
+    // Base-6 digit to face, same mapping as roll()
+    static constexpr Side faces[6] = {L, C, R, Wild, Dot, Dot};
+
+    // Alias table for one dice count. Weights are the exact number of face sequences (out
+    // of 6^numDice) producing each outcome, so the table is exact up to Rng::scale's bias.
+    struct AliasEntry {
+        uint16_t threshold; // Keep `primary` when the in-column draw is below this
+        Roll primary;
+        Roll alias;
+    };
+
+    struct AliasTable {
+        uint32_t sequences;  // 6^numDice, the width of every column
+        uint32_t range;      // columns * sequences
+        uint32_t reciprocal; // floor(2^32 / sequences) + 1: v / sequences == (v * reciprocal) >> 32 for v < range
+        AliasEntry entries[35];
+    };
+
+    static const AliasTable& aliasTable(int numDice);
+    static AliasTable buildAliasTable(int numDice);
 };
 
-#endif //LCR_DICE_H
\ No newline at end of file
+inline Dice::Roll Dice::rollTurn(int numDice, uint64_t word) {
+    const AliasTable& table = aliasTable(numDice);
+    uint32_t v = Rng::scale(word, table.range);
+    uint32_t column = static_cast<uint32_t>((static_cast<uint64_t>(v) * table.reciprocal) >> 32);
+    const AliasEntry& entry = table.entries[column];
+    return (v - column * table.sequences) < entry.threshold ? entry.primary : entry.alias;
+}
+
+inline const Dice::AliasTable& Dice::aliasTable(int numDice) {
+    static const AliasTable tables[MaxDicePerTurn] = {buildAliasTable(1), buildAliasTable(2), buildAliasTable(3)};
+    return tables[numDice - 1];
+}
+
+inline std::map<uint16_t, uint32_t> Dice::outcomeWeights(int numDice) {
+    uint32_t sequences = 1;
+    for (int k = 0; k < numDice; ++k) { sequences *= 6; }
+
+    // Count how many face sequences produce each packed outcome
+    std::map<uint16_t, uint32_t> weights;
+    for (uint32_t sequence = 0; sequence < sequences; ++sequence) {
+        uint16_t packed = 0;
+        uint32_t digits = sequence;
+        for (int k = 0; k < numDice; ++k) {
+            packed += 1u << (2 * faces[digits % 6]);
+            digits /= 6;
+        }
+        if ((packed & 0x3F) == 0) { packed |= DotsOrWildsFlag; } // No L, C or R
+        weights[packed]++;
+    }
+    return weights;
+}
+
+inline Dice::AliasTable Dice::buildAliasTable(int numDice) {
+    AliasTable table{};
+    table.sequences = 1;
+    for (int k = 0; k < numDice; ++k) { table.sequences *= 6; }
+
+    std::map<uint16_t, uint32_t> weights = outcomeWeights(numDice);
+
+    // Vose's alias construction in integers: each column holds `sequences` units
+    std::vector<Roll> outcomes;
+    std::vector<uint32_t> scaled;
+    for (const auto& [packed, weight] : weights) {
+        outcomes.push_back(Roll{packed});
+        scaled.push_back(weight * static_cast<uint32_t>(weights.size()));
+    }
+    table.range = static_cast<uint32_t>(outcomes.size()) * table.sequences;
+    table.reciprocal = static_cast<uint32_t>((1ULL << 32) / table.sequences + 1);
+
+    std::vector<size_t> small, large;
+    for (size_t i = 0; i < scaled.size(); ++i) {
+        (scaled[i] < table.sequences ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        size_t s = small.back(); small.pop_back();
+        size_t l = large.back();
+        table.entries[s] = {static_cast<uint16_t>(scaled[s]), outcomes[s], outcomes[l]};
+        scaled[l] -= table.sequences - scaled[s];
+        if (scaled[l] < table.sequences) { large.pop_back(); small.push_back(l); }
+    }
+    for (size_t i : large) { table.entries[i] = {static_cast<uint16_t>(table.sequences), outcomes[i], outcomes[i]}; }
+    for (size_t i : small) { table.entries[i] = {static_cast<uint16_t>(table.sequences), outcomes[i], outcomes[i]}; }
+
+    return table;
+}
+
+#endif //LCR_DICE_H
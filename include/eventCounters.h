@@ -0,0 +1,147 @@
+// =========================================================================
+// eventCounters.h
+// =========================================================================
+#ifndef LCR_EVENTCOUNTERS_H
+#define LCR_EVENTCOUNTERS_H
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "player.h"
+#include "dice.h"
+
+// Counts of what happens inside the games, by the strategy of the player it happened to.
+// Only built with LCR_EVENT_COUNTERS defined (CMake option LCR_ENABLE_EVENT_COUNTERS); otherwise
+// every call below is an empty inline function and the engines compile to the same code as
+// without them. Each thread counts into its own block, found through a thread_local pointer.
+class EventCounters {
+public:
+#ifdef LCR_EVENT_COUNTERS
+    static constexpr bool Enabled = true;
+#else
+    static constexpr bool Enabled = false;
+#endif
+
+    enum Event {
+        Turns,              // Rolls taken, including winning ones
+        DiceThrown,
+        CancelledCenter,    // Wilds spent cancelling a C
+        CancelledSides,     // Wilds spent cancelling an L or R
+        Steals,             // Wilds that took a chip
+        FailedSteals,       // Wilds left as steals with nobody to steal from
+        LastPlayerRetries,  // Rolls by the last player holding chips that did not win
+        NumEvents
+    };
+
+    static constexpr int NumStrategies = Player::PlayStyle::StealOppositeConditional + 1;
+
+    struct Block {
+        uint64_t counts[NumStrategies][NumEvents] = {};
+    };
+
+    static const char* eventName(Event event);
+
+    static void add(Player::PlayStyle style, Event event, uint64_t count = 1) {
+        if constexpr (Enabled) { local().counts[style][event] += count; }
+    }
+
+    // A roll about to be played
+    static void turn(Player::PlayStyle style, Dice::Roll roll) {
+        if constexpr (Enabled) {
+            Block& block = local();
+            block.counts[style][Turns]++;
+            block.counts[style][DiceThrown] += roll.count(Dice::L) + roll.count(Dice::C) + roll.count(Dice::R) +
+                                         roll.count(Dice::Dot) + roll.count(Dice::Wild);
+        }
+    }
+
+    // The wilds a roll spent on cancellations, from its faces and its resolved moves
+    template <typename Moves>
+    static void cancellations(Player::PlayStyle style, Dice::Roll roll, const Moves& moves) {
+        if constexpr (Enabled) {
+            Block& block = local();
+            block.counts[style][CancelledCenter] += roll.count(Dice::C) - moves.toPot;
+            block.counts[style][CancelledSides] += roll.count(Dice::L) - moves.passLeft + roll.count(Dice::R) - moves.passRight;
+        }
+    }
+
+    // Sum over every thread that has counted so far; call while no games are being played
+    static Block merge();
+
+    // While alive, the calling thread counts into a scratch block instead, e.g. while replaying
+    // a game that was already counted to record its chip history
+    class Mute {
+    public:
+        Mute() {
+            if constexpr (Enabled) {
+                this->saved = current();
+                current() = &scratch();
+            }
+        }
+        ~Mute() {
+            if constexpr (Enabled) { current() = this->saved; }
+        }
+        Mute(const Mute&) = delete;
+        Mute& operator=(const Mute&) = delete;
+
+    private:
+        Block* saved = nullptr;
+    };
+
+private:
+    static Block& local() { return *current(); }
+
+    static Block*& current() {
+        thread_local Block* block = registerBlock();
+        return block;
+    }
+
+    static Block& scratch() {
+        thread_local Block block;
+        return block;
+    }
+
+    // Blocks are owned here so they outlive their threads
+    static Block* registerBlock() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(std::make_unique<Block>());
+        return registry().back().get();
+    }
+
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<std::unique_ptr<Block>>& registry() {
+        static std::vector<std::unique_ptr<Block>> blocks;
+        return blocks;
+    }
+};
+
+inline const char* EventCounters::eventName(Event event) {
+    switch (event) {
+        case Turns: return "Turns";
+        case DiceThrown: return "Dice";
+        case CancelledCenter: return "Wilds on C";
+        case CancelledSides: return "Wilds on L/R";
+        case Steals: return "Steals";
+        case FailedSteals: return "Failed steals";
+        case LastPlayerRetries: return "Last-player rerolls";
+        default: return "Unknown";
+    }
+}
+
+inline EventCounters::Block EventCounters::merge() {
+    Block total;
+    std::lock_guard<std::mutex> lock(registryMutex());
+    for (const auto& block : registry()) {
+        for (int style = 0; style < NumStrategies; ++style) {
+            for (int event = 0; event < NumEvents; ++event) { total.counts[style][event] += block->counts[style][event]; }
+        }
+    }
+    return total;
+}
+
+#endif //LCR_EVENTCOUNTERS_H
@@ -11,217 +11,163 @@
 #include <algorithm>
 #include <map>
 #include "player.h"
+#include "gameState.h"
 #include "dice.h"
+#include "rng.h"
 #include "helpers.h"
 #include "result.h" // Include the new Result class definition
+#include "chipHistory.h"
+#include "roundStats.h"
+#include "eventCounters.h"
 
+// Rules engine for one game of LCR, played on a GameState owned by the caller
 class Game {
 private:
-    std::vector<Player> players;
-    int pot;
-    int numOfPlayers;
-    int initialChips; // Store initial chips per player
-    std::vector<Player::PlayStyle> initialStrategies; // Store initial strategies
+    GameState& state;
 
     bool keepPlay();
 
 public:
-    Game(int numPlayers, int startingChips = 3, Player::PlayStyle defaultStyle = Player::PlayStyle::StealFromOpposite);
-    // Constructor allowing mixed strategies
-    Game(const std::vector<Player::PlayStyle>& strategies, int startingChips = 3);
-    // Constructor taking full player objects (less used now but kept for flexibility)
-    Game(std::vector<Player> initialPlayers);
+    explicit Game(GameState& gameState) : state(gameState) {}
 
     // Play the game and return the result
-    Result play(int gameId); // Takes gameId for result tracking
-    int getNumOfPlayers() const { return numOfPlayers; }
+    // Takes gameId for result tracking and the generator that drives every dice roll.
+    // A recorder, if given, is handed the chips at the deal and after every turn; roundStats,
+    // if given, gets the chips at the end of every round.
+    Result play(int gameId, Rng& rng, ChipRecorder* recorder = nullptr, RoundStats::Accumulator* roundStats = nullptr);
+    int getNumOfPlayers() const { return state.getNumSeats(); }
+
+    // Plays out one roll for `seat`; also used by the exact solver to walk every roll outcome
+    bool takeTurn(int seat, Dice::Roll roll);
+
+    // Chips a roll asks to move before they are capped by what the roller holds, after the
+    // roller's strategy has spent its wilds on cancellations; the remaining wilds are steals
+    struct Moves {
+        int passLeft;
+        int toPot;
+        int passRight;
+        int steals;
+    };
+
+    // The wild-cancellation rules, shared by every engine
+    static Moves resolveRoll(Player::PlayStyle style, Dice::Roll roll);
 };
 
-// Constructor implementation (uniform style)
-//Game::Game(int numPlayers, int startingChips, Player::PlayStyle defaultStyle)
-//        : numOfPlayers(numPlayers), pot(0), initialChips(startingChips) {
-//    if (numPlayers < 2) throw std::invalid_argument("Game requires at least 2 players.");
-//    if (startingChips <= 0) throw std::invalid_argument("Players must start with chips.");
-//
-//    initialStrategies.reserve(numPlayers);
-//    players.reserve(numPlayers);
-//    for (int i = 0; i < numPlayers; ++i) {
-//        std::string name = "Player ";
-//        name += std::to_string(i + 1);
-//        players.emplace_back(name, startingChips, i, defaultStyle, numPlayers);
-//        initialStrategies.push_back(defaultStyle);
-//    }
-//    // std::cout << "Game created with " << numPlayers << " players, " << startingChips << " chips each, using strategy: "
-//    //           << Player::playStyleToString(defaultStyle) << std::endl; // Verbose logging removed for bulk runs
-//}
-
-// Constructor implementation (mixed styles)
-//Game::Game(const std::vector<Player::PlayStyle>& strategies, int startingChips)
-//        : numOfPlayers(strategies.size()), pot(0), initialChips(startingChips), initialStrategies(strategies) {
-//    if (numOfPlayers < 2) throw std::invalid_argument("Game requires at least 2 players.");
-//    if (startingChips <= 0) throw std::invalid_argument("Players must start with chips.");
-//
-//    players.reserve(numOfPlayers);
-//    for (int i = 0; i < numOfPlayers; ++i) {
-//        std::string name = "Player ";
-//        name += std::to_string(i + 1);
-//        players.emplace_back(name, startingChips, i, strategies[i], numOfPlayers);
-//    }
-//    // std::cout << "Game created with " << numOfPlayers << " players, " << startingChips << " chips each, with mixed strategies." << std::endl;
-//}
-
-
-// Constructor implementation (taking vector of Player objects)
-Game::Game(std::vector<Player> initialPlayers) : players(std::move(initialPlayers)), pot(0) {
-    this->numOfPlayers = players.size();
-    if (this->numOfPlayers < 2) throw std::invalid_argument("Game requires at least 2 players.");
-    // Infer initial state (assuming uniform start for simplicity here)
-    this->initialChips = (players.empty() ? 0 : players[0].getChips());
-    this->initialStrategies.reserve(numOfPlayers);
-    for(const auto& p : players) {
-        this->initialStrategies.push_back(p.getPlayStyle());
-        // Basic check for consistency - real use might need more robust handling
-        if (p.getChips() != this->initialChips) {
-            std::cerr << "Warning: Constructing Game from players with non-uniform starting chips." << std::endl;
+// keepPlay implementation
+bool Game::keepPlay() {
+    return state.getPlayersWithChips() >= 1;
+}
+
+Game::Moves Game::resolveRoll(Player::PlayStyle style, Dice::Roll roll) {
+    Moves moves{roll.count(Dice::L), roll.count(Dice::C), roll.count(Dice::R), 0};
+    int wilds = roll.count(Dice::Wild);
+    if (wilds == 0) return moves;
+
+    switch (style) {
+        case Player::PlayStyle::StealFromHighest:
+        case Player::PlayStyle::StealFromLowest:
+            break; // Always steal
+        case Player::PlayStyle::StealFromOpposite: { // W cancels C > L > R
+            int cancelC = std::min(wilds, moves.toPot); wilds -= cancelC; moves.toPot -= cancelC;
+            int cancelL = std::min(wilds, moves.passLeft); wilds -= cancelL; moves.passLeft -= cancelL;
+            int cancelR = std::min(wilds, moves.passRight); wilds -= cancelR; moves.passRight -= cancelR;
+            break;
+        }
+        case Player::PlayStyle::StealOppositeConditional: { // W cancels C only
+            int cancelC = std::min(wilds, moves.toPot); wilds -= cancelC; moves.toPot -= cancelC;
+            break;
         }
+        default:
+            return moves;
     }
-    // std::cout << "Game created from pre-defined player vector." << std::endl;
+    moves.steals = wilds;
+    return moves;
 }
 
+// Plays out one player's roll against the table. Returns true when the roll wins the game:
+// the roller is the only player left with chips and rolled nothing but dots and wilds.
+bool Game::takeTurn(int seat, Dice::Roll roll) {
+    // Check if only one player has chips, if so, they need to roll all dots or wilds
+    bool onlyOnePlayerWithChips = (state.getPlayersWithChips() == 1);
+    const Player::PlayStyle style = state.getStrategy(seat);
+    EventCounters::turn(style, roll);
 
-// keepPlay implementation
-bool Game::keepPlay() {
-    int count = 0;
-    for (const Player& p : players) { if (p.getChips() > 0) { count++; } }
-    return count >= 1;
+    if (onlyOnePlayerWithChips && roll.onlyDotsOrWilds()) {
+        return true;
+    }
+    // Otherwise the roll is played out as usual, even for the last player with chips
+    if (onlyOnePlayerWithChips) { EventCounters::add(style, EventCounters::LastPlayerRetries); }
+
+    const Moves moves = resolveRoll(style, roll);
+    EventCounters::cancellations(style, roll, moves);
+    int netPassLeft = moves.passLeft;
+    int netToPot = moves.toPot;
+    int netPassRight = moves.passRight;
+    int stealsToAttempt = moves.steals;
+
+    int chipsAvailable = state.getChips(seat);
+    int chipsToRemoveTotal = 0;
+
+    int actualPassLeft = std::min(netPassLeft, chipsAvailable - chipsToRemoveTotal);
+    if (actualPassLeft > 0) { state.addChips(state.leftOf(seat), actualPassLeft); chipsToRemoveTotal += actualPassLeft; }
+    int actualToPot = std::min(netToPot, chipsAvailable - chipsToRemoveTotal);
+    if (actualToPot > 0) { state.addToPot(actualToPot); chipsToRemoveTotal += actualToPot; }
+    int actualPassRight = std::min(netPassRight, chipsAvailable - chipsToRemoveTotal);
+    if (actualPassRight > 0) { state.addChips(state.rightOf(seat), actualPassRight); chipsToRemoveTotal += actualPassRight; }
+
+    if (chipsToRemoveTotal > 0) { state.removeChips(seat, chipsToRemoveTotal); }
+
+    // --- Attempt Steals ---
+    if (stealsToAttempt > 0) {
+        // std::cout << "    Attempting " << stealsToAttempt << " steal(s)..." << std::endl; // Verbose
+        for (int k = 0; k < stealsToAttempt; ++k) {
+            const bool stole = state.attemptSteal(seat);
+            EventCounters::add(style, stole ? EventCounters::Steals : EventCounters::FailedSteals);
+        }
+    }
+
+    return false;
 }
 
 // play implementation - Now returns a Result object
-Result Game::play(int gameId) {
-//    std::vector<std::vector<int>> chipHistory;
-//    std::vector<int> initialState;
-//    for (const auto& player : players) {
-//        initialState.push_back(player.getChips());
-//    }
-//    chipHistory.push_back(initialState);
+Result Game::play(int gameId, Rng& rng, ChipRecorder* recorder, RoundStats::Accumulator* roundStats) {
+    if (recorder) { recorder->begin(state); }
+
+    const int numOfPlayers = state.getNumSeats();
 
     int round = 0; // Start at round 0, increment at start of loop
     while (keepPlay()) {
         round++;
 
         // std::cout << "\n--- Round " << round << " ---" << std::endl; // Verbose logging removed
-        for (int i = 0; i < numOfPlayers; ++i) {
-            Player &p = players[i];
-            if (p.getChips() == 0) continue;
-
-            int numOfRolls = std::min(p.getChips(), 3);
-            if (numOfRolls == 0) continue;
-
-            std::vector<Dice::Side> rollResults;
-            rollResults.reserve(numOfRolls);
-            std::map<Dice::Side, int> rollCounts;
-            for (int j = 0; j < numOfRolls; ++j) {
-                Dice::Side result = Dice::roll();
-                rollCounts[result]++;
-                rollResults.push_back(result);
-            }
-
-            // Check if only one player has chips, if so, they need to roll all dots or wilds
-            bool onlyOnePlayerWithChips = (std::count_if(players.begin(), players.end(),
-                                                         [](const Player& p) { return p.getChips() > 0; }) == 1);
-
-            if (onlyOnePlayerWithChips) {
-                for (Player& p : players) {
-                    if (p.getChips() > 0) {
-                        bool allDotsOrWilds = std::all_of(rollResults.begin(), rollResults.end(),
-                                                          [](Dice::Side side) {
-                                                              return side == Dice::Dot || side == Dice::Wild;
-                                                          });
-
-                        if (allDotsOrWilds) {
-                            // Player wins - rolled all dots or wilds
-                            return Result(gameId, p.getName(), p.getPlayStyle(), round, numOfPlayers, initialChips, initialStrategies);
-                        } else {
-                            // Player must continue - didn't roll all dots or wilds
-                            break;
-                        }
-                    }
+        // Turns go round the table in seat order from the game's first seat: seats
+        // [start, n) then [0, start). Seats without chips are skipped via the alive bitmask.
+        const int startSeat = state.getStartSeat();
+        for (int segment = 0; segment < 2; ++segment) {
+            const int endSeat = segment == 0 ? numOfPlayers : startSeat;
+            for (int seat = state.nextWithChips(segment == 0 ? startSeat : 0); seat < endSeat; seat = state.nextWithChips(seat + 1)) {
+                int numOfRolls = std::min(state.getChips(seat), Dice::MaxDicePerTurn);
+
+                // One draw decides the whole roll
+                Dice::Roll roll = Dice::rollTurn(numOfRolls, rng.next());
+
+                if (takeTurn(seat, roll)) {
+                    // Player wins - last player with chips rolled all dots or wilds
+                    if (roundStats) { roundStats->add(round, state.chipData(), state.getNumSeats()); }
+                    return Result(gameId, seat, state.getStrategy(seat), round, numOfPlayers, state.getInitialChips(), state.getAssignment());
                 }
-            }
 
-            // std::cout << "\n" << p.getName() << "'s turn (Chips: " << p.getChips() << ")" << std::endl; // Verbose
-
-            // std::cout << "  Rolling " << numOfRolls << " dice: "; // Verbose
-
-            // std::cout << std::endl; // Verbose
-
-            int netPassLeft = rollCounts[Dice::L];
-            int netPassRight = rollCounts[Dice::R];
-            int netToPot = rollCounts[Dice::C];
-            int netWilds = rollCounts[Dice::Wild];
-            int stealsToAttempt = 0;
-            int chipsKeptFromCancellation = 0;
-
-            if (netWilds > 0) {
-                switch (p.getPlayStyle()) {
-                    case Player::PlayStyle::StealFromHighest:
-                    case Player::PlayStyle::StealFromLowest:
-                        stealsToAttempt = netWilds;
-                        // std::cout << "    (Wild logic: Always Steal)" << std::endl; // Verbose
-                        break;
-                    case Player::PlayStyle::StealFromOpposite: { // W cancels C > L > R
-                        // std::cout << "    (Wild logic: Opposite C>L>R)" << std::endl; // Verbose
-                        int currentWilds = netWilds;
-                        int cancelC = std::min(currentWilds, netToPot); if (cancelC > 0) { currentWilds -= cancelC; netToPot -= cancelC; chipsKeptFromCancellation += cancelC; }
-                        int cancelL = std::min(currentWilds, netPassLeft); if (cancelL > 0) { currentWilds -= cancelL; netPassLeft -= cancelL; chipsKeptFromCancellation += cancelL; }
-                        int cancelR = std::min(currentWilds, netPassRight); if (cancelR > 0) { currentWilds -= cancelR; netPassRight -= cancelR; chipsKeptFromCancellation += cancelR; }
-                        stealsToAttempt = currentWilds;
-                        break;
-                    }
-                    case Player::PlayStyle::StealOppositeConditional: { // W cancels C only
-                        // std::cout << "    (Wild logic: Opposite Conditional C)" << std::endl; // Verbose
-                        int currentWilds = netWilds;
-                        int cancelC = std::min(currentWilds, netToPot); if (cancelC > 0) { currentWilds -= cancelC; netToPot -= cancelC; chipsKeptFromCancellation += cancelC; }
-                        stealsToAttempt = currentWilds;
-                        break;
-                    }
-                } // End switch(PlayStyle)
-            } // End if (netWilds > 0)
-
-            int chipsAvailable = p.getChips();
-            int chipsToRemoveTotal = 0;
-
-            int actualPassLeft = std::min(netPassLeft, chipsAvailable - chipsToRemoveTotal);
-            if (actualPassLeft > 0) { int leftIdx = Helpers::calculateNeededPlayerIndex(numOfPlayers, i, Helpers::Direction::Left); players.at(leftIdx).addChips(actualPassLeft); chipsToRemoveTotal += actualPassLeft; }
-            int actualToPot = std::min(netToPot, chipsAvailable - chipsToRemoveTotal);
-            if (actualToPot > 0) { this->pot += actualToPot; chipsToRemoveTotal += actualToPot; }
-            int actualPassRight = std::min(netPassRight, chipsAvailable - chipsToRemoveTotal);
-            if (actualPassRight > 0) { int rightIdx = Helpers::calculateNeededPlayerIndex(numOfPlayers, i, Helpers::Direction::Right); players.at(rightIdx).addChips(actualPassRight); chipsToRemoveTotal += actualPassRight; }
-
-            if (chipsToRemoveTotal > 0) { p.removeChips(chipsToRemoveTotal); }
-
-            // --- Attempt Steals ---
-            if (stealsToAttempt > 0) {
-                // std::cout << "    Attempting " << stealsToAttempt << " steal(s)..." << std::endl; // Verbose
-                for (int k = 0; k < stealsToAttempt; ++k) {
-                    p.attemptSteal(players); // Ignore return value for bulk runs, just attempt
-                }
+                if (recorder) { recorder->turn(state); }
             }
-            // std::cout << "    Turn End: " << p.getName() << " has " << p.getChips() << " chips. Pot: " << this->pot << "." << std::endl; // Verbose
-//            std::vector<int> currentState;
-//            for (const auto& player : players) {
-//                currentState.push_back(player.getChips());
-//            }
-//            chipHistory.push_back(currentState);
         } // End player turn loop
+
+        if (roundStats) { roundStats->add(round, state.chipData(), state.getNumSeats()); }
     } // End game loop
 
     // Draw or unexpected state
-    // std::cout << "\n--- Game Over! Draw or Error ---" << std::endl; // Verbose
     // In a draw, pot is lost? Or split? We'll assume lost for now.
-    // Return a result indicating a draw, using a placeholder strategy or the first player's strategy.
-    Player::PlayStyle placeholderStrat = initialStrategies.empty() ? Player::PlayStyle::StealFromHighest : initialStrategies[0];
-    return Result(gameId, "DRAW", placeholderStrat, round, numOfPlayers, initialChips, initialStrategies, true);
+    // Return a result indicating a draw, using the first seat's strategy as a placeholder.
+    return Result(gameId, Result::NoWinner, state.getStrategy(0), round, numOfPlayers, state.getInitialChips(), state.getAssignment(), true);
 }
 
 #endif //LCR_GAME_H
\ No newline at end of file
@@ -0,0 +1,425 @@
+// =========================================================================
+// gameState.h
+// =========================================================================
+#ifndef LCR_GAMESTATE_H
+#define LCR_GAMESTATE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include "player.h"
+#include "rng.h"
+
+// The players of a run, held once and shared read-only by every game.
+// Seats are the players' config indices; turn order goes up in seat number.
+class Roster {
+public:
+    // Seat counts are uint16_t and a seat can end up holding every chip on the table, so this
+    // bounds each seat's starting chips and the table's total
+    static constexpr int MaxChips = UINT16_MAX;
+
+    // Throws std::invalid_argument for indices that do not cover 0..N-1 or chips out of range
+    explicit Roster(const std::vector<Player>& players);
+
+    int size() const { return static_cast<int>(this->names.size()); }
+    const std::string& name(int seat) const { return this->names[seat]; }
+    uint16_t startingChips(int seat) const { return this->chips[seat]; }
+    Player::PlayStyle strategy(int seat) const { return this->strategies[seat]; } // May be Random
+    const std::vector<Player::PlayStyle>& getStrategies() const { return this->strategies; }
+
+private:
+    std::vector<std::string> names;
+    std::vector<uint16_t> chips;
+    std::vector<Player::PlayStyle> strategies;
+};
+
+// How each batch is dealt: its concrete strategies (Random seats drawn once per batch) and
+// the seat that rolls first, held once and shared by all of the batch's replays. Game g
+// belongs to batch g / gamesPerBatch; results refer to a batch by its index. Without Random
+// seats every batch has the roster's strategies, which are then stored once for all of them.
+class BatchTable {
+public:
+    // Deals numBatches batches from their Rng(seed, BatchStreamBase + batch) streams.
+    // startingPlayer is 1-based; a negative value draws a starter for every batch.
+    BatchTable(const Roster& roster, uint64_t seed, int numBatches, int gamesPerBatch, int startingPlayer);
+
+    int size() const { return static_cast<int>(this->startSeats.size()); }
+    int batchOf(int gameId) const { return gameId / this->gamesPerBatch; }
+
+    const std::vector<Player::PlayStyle>& strategies(int batch) const {
+        return this->assignments.empty() ? this->fixed : this->assignments[batch];
+    }
+    int startSeat(int batch) const { return this->startSeats[batch]; }
+
+private:
+    int gamesPerBatch;
+    std::vector<Player::PlayStyle> fixed;                    // The roster's strategies
+    std::vector<std::vector<Player::PlayStyle>> assignments; // Per batch; empty without Random seats
+    std::vector<int> startSeats;
+};
+
+// Seat-indexed chip and strategy arrays for one table.
+// Each worker keeps one GameState and reset()s it between games, so playing a game
+// allocates nothing once the arrays have been sized for the roster.
+class GameState {
+public:
+    GameState() : numSeats(0), startSeat(0), pot(0), initialChips(0), playersWithChips(0),
+                  ranked(false), leafBase(1), assignment(nullptr) {}
+
+    // Deal a new game: starting chips from the roster, the batch's concrete strategies
+    // (one per seat, must outlive the game's Result) and the seat that rolls first
+    void reset(const Roster& roster, const std::vector<Player::PlayStyle>& seatStrategies, int firstSeat);
+
+    int getNumSeats() const { return this->numSeats; }
+    int getStartSeat() const { return this->startSeat; }
+    int getPot() const { return this->pot; }
+    int getInitialChips() const { return this->initialChips; }
+
+    int getChips(int seat) const { return this->chips[seat]; }
+    const uint16_t* chipData() const { return this->chips.data(); } // One per seat
+    void setChips(int seat, int num);
+    void addChips(int seat, int num);
+    void removeChips(int seat, int num); // Clamps at zero like Player::removeChips
+    void addToPot(int num) { this->pot += num; }
+
+    // Players still holding chips, maintained as chips move so the end-of-game and
+    // last-player checks are O(1)
+    int getPlayersWithChips() const { return this->playersWithChips; }
+    bool hasChips(int seat) const { return (this->alive[seat >> 6] >> (seat & 63)) & 1; }
+
+    // First seat at or after `seat` (without wrapping) holding chips, or getNumSeats() if none
+    int nextWithChips(int seat) const;
+    // Last seat at or before `seat` (without wrapping) holding chips, or -1 if none
+    int prevWithChips(int seat) const;
+
+    Player::PlayStyle getStrategy(int seat) const { return this->strategies[seat]; }
+    const std::vector<Player::PlayStyle>* getAssignment() const { return this->assignment; }
+
+    // Neighbouring seats around the circle
+    int leftOf(int seat) const { return seat == 0 ? this->numSeats - 1 : seat - 1; }
+    int rightOf(int seat) const { return seat + 1 == this->numSeats ? 0 : seat + 1; }
+
+    // Handles a 'Wild' that resolves to a steal for `thief`, choosing the target by the
+    // thief's strategy. Ties on chip count go to the lowest seat. Returns true if a chip moved.
+    // Allocation-free; O(log N) via the indexed lookups below on tables larger than
+    // LinearScanSeats, where a plain scan of the chip array is cheaper.
+    bool attemptSteal(int thief);
+
+    static constexpr int LinearScanSeats = 32;
+
+    // Steal targets for `thief`, or -1 if nobody else holds chips
+    int scanTarget(int thief) const;
+    int highestTarget(int thief) const;
+    int lowestTarget(int thief) const;
+    int oppositeTarget(int thief) const;
+
+private:
+    // Seats are packed into the low 16 bits of the ranking keys
+    static constexpr int MaxSeats = 0xFFFF;
+
+    void markAlive(int seat) { this->alive[seat >> 6] |= 1ULL << (seat & 63); this->playersWithChips++; }
+    void markEmpty(int seat) { this->alive[seat >> 6] &= ~(1ULL << (seat & 63)); this->playersWithChips--; }
+
+    // Re-ranks `seat` in the steal trees after its chip count changed
+    void updateRank(int seat);
+
+    int numSeats;
+    int startSeat;
+    int pot;
+    int initialChips;
+    int playersWithChips;
+    std::vector<uint16_t> chips;
+    std::vector<uint64_t> alive; // Bit per seat, set while the seat holds chips
+    std::vector<uint16_t> opposite; // Seat across the table from each seat
+
+    // Tournament trees over seats for the highest / lowest steal targets, maintained only
+    // when some seat uses one of those strategies. Leaves sit at [leafBase, 2 * leafBase).
+    // Max keys are (chips << 16 | ~seat) so ties pick the lowest seat, 0 for empty seats;
+    // min keys are (chips << 16 | seat), UINT32_MAX for empty seats.
+    bool ranked;
+    size_t leafBase;
+    std::vector<uint32_t> maxTree;
+    std::vector<uint32_t> minTree;
+    std::vector<Player::PlayStyle> strategies;
+    const std::vector<Player::PlayStyle>* assignment; // The batch table `strategies` was copied from
+};
+
+inline Roster::Roster(const std::vector<Player>& players) {
+    this->names.resize(players.size());
+    this->chips.resize(players.size());
+    this->strategies.resize(players.size());
+    int64_t totalChips = 0;
+    for (const Player& p : players) {
+        int seat = p.getIndex();
+        if (seat < 0 || seat >= static_cast<int>(players.size())) {
+            throw std::invalid_argument("Player indices must cover 0..N-1.");
+        }
+        if (p.getChips() < 0 || p.getChips() > MaxChips) {
+            throw std::invalid_argument("Player chips must be between 0 and " + std::to_string(MaxChips) + ".");
+        }
+        totalChips += p.getChips();
+        this->names[seat] = p.getName();
+        this->chips[seat] = static_cast<uint16_t>(p.getChips());
+        this->strategies[seat] = p.getPlayStyle();
+    }
+    if (totalChips > MaxChips) {
+        throw std::invalid_argument("A table holds at most " + std::to_string(MaxChips) + " chips in all.");
+    }
+}
+
+inline BatchTable::BatchTable(const Roster& roster, uint64_t seed, int numBatches, int gamesPerBatch, int startingPlayer)
+        : gamesPerBatch(gamesPerBatch), fixed(roster.getStrategies()), startSeats(numBatches) {
+    if (std::find(this->fixed.begin(), this->fixed.end(), Player::PlayStyle::Random) != this->fixed.end()) {
+        this->assignments.assign(numBatches, this->fixed);
+    }
+    for (int batch = 0; batch < numBatches; ++batch) {
+        // Randomize once per batch (not per simulation)
+        Rng batchRng(seed, Rng::BatchStreamBase + batch);
+        this->startSeats[batch] = startingPlayer < 0 ? static_cast<int>(batchRng.below(roster.size())) : startingPlayer - 1;
+        if (this->assignments.empty()) continue;
+        for (Player::PlayStyle& strategy : this->assignments[batch]) {
+            if (strategy == Player::PlayStyle::Random) {
+                strategy = static_cast<Player::PlayStyle>(batchRng.below(Player::PlayStyle::StealOppositeConditional + 1));
+            }
+        }
+    }
+}
+
+inline void GameState::reset(const Roster& roster, const std::vector<Player::PlayStyle>& seatStrategies, int firstSeat) {
+    if (roster.size() > MaxSeats) throw std::invalid_argument("Too many players.");
+
+    const bool sameTable = this->numSeats == roster.size();
+    this->numSeats = roster.size();
+    this->startSeat = firstSeat;
+    this->pot = 0;
+    this->initialChips = roster.startingChips(0);
+    this->assignment = &seatStrategies;
+
+    // Same-size resizes keep the existing storage
+    this->chips.resize(this->numSeats);
+    this->strategies.resize(this->numSeats);
+    this->alive.assign((this->numSeats + 63) / 64, 0);
+    this->playersWithChips = 0;
+    this->ranked = false;
+    for (int seat = 0; seat < this->numSeats; ++seat) {
+        this->chips[seat] = roster.startingChips(seat);
+        this->strategies[seat] = seatStrategies[seat];
+        if (this->chips[seat] > 0) { markAlive(seat); }
+        if (seatStrategies[seat] == Player::PlayStyle::StealFromHighest || seatStrategies[seat] == Player::PlayStyle::StealFromLowest) {
+            this->ranked = this->numSeats > LinearScanSeats;
+        }
+    }
+
+    if (!sameTable || this->opposite.empty()) {
+        this->opposite.resize(this->numSeats);
+        for (int seat = 0; seat < this->numSeats; ++seat) {
+            this->opposite[seat] = static_cast<uint16_t>((seat + this->numSeats / 2) % this->numSeats);
+        }
+        this->leafBase = 1;
+        while (this->leafBase < static_cast<size_t>(this->numSeats)) { this->leafBase <<= 1; }
+    }
+
+    if (this->ranked) {
+        // Build the trees bottom-up; padding leaves hold the identity keys
+        this->maxTree.assign(2 * this->leafBase, 0);
+        this->minTree.assign(2 * this->leafBase, UINT32_MAX);
+        for (int seat = 0; seat < this->numSeats; ++seat) {
+            uint32_t c = this->chips[seat];
+            if (c == 0) continue;
+            this->maxTree[this->leafBase + seat] = (c << 16) | (0xFFFFu - static_cast<uint32_t>(seat));
+            this->minTree[this->leafBase + seat] = (c << 16) | static_cast<uint32_t>(seat);
+        }
+        for (size_t i = this->leafBase - 1; i > 0; --i) {
+            this->maxTree[i] = std::max(this->maxTree[2 * i], this->maxTree[2 * i + 1]);
+            this->minTree[i] = std::min(this->minTree[2 * i], this->minTree[2 * i + 1]);
+        }
+    }
+}
+
+inline void GameState::setChips(int seat, int num) {
+    bool had = this->chips[seat] > 0;
+    this->chips[seat] = static_cast<uint16_t>(num);
+    if (had && num <= 0) { markEmpty(seat); }
+    if (!had && num > 0) { markAlive(seat); }
+    if (this->ranked) { updateRank(seat); }
+}
+
+inline void GameState::addChips(int seat, int num) {
+    if (this->chips[seat] == 0 && num > 0) { markAlive(seat); }
+    this->chips[seat] = static_cast<uint16_t>(this->chips[seat] + num);
+    if (this->ranked) { updateRank(seat); }
+}
+
+inline void GameState::removeChips(int seat, int num) {
+    int remaining = this->chips[seat] - num;
+    if (remaining <= 0 && this->chips[seat] > 0) { markEmpty(seat); }
+    this->chips[seat] = static_cast<uint16_t>(remaining < 0 ? 0 : remaining);
+    if (this->ranked) { updateRank(seat); }
+}
+
+inline void GameState::updateRank(int seat) {
+    uint32_t c = this->chips[seat];
+    size_t i = this->leafBase + seat;
+    this->maxTree[i] = c ? (c << 16) | (0xFFFFu - static_cast<uint32_t>(seat)) : 0;
+    this->minTree[i] = c ? (c << 16) | static_cast<uint32_t>(seat) : UINT32_MAX;
+    for (i >>= 1; i > 0; i >>= 1) {
+        this->maxTree[i] = std::max(this->maxTree[2 * i], this->maxTree[2 * i + 1]);
+        this->minTree[i] = std::min(this->minTree[2 * i], this->minTree[2 * i + 1]);
+    }
+}
+
+inline int GameState::nextWithChips(int seat) const {
+    if (seat >= this->numSeats) return this->numSeats;
+    size_t word = static_cast<size_t>(seat) >> 6;
+    uint64_t bits = this->alive[word] & (~0ULL << (seat & 63));
+    while (bits == 0) {
+        if (++word == this->alive.size()) return this->numSeats;
+        bits = this->alive[word];
+    }
+    return static_cast<int>(word * 64 + __builtin_ctzll(bits));
+}
+
+inline int GameState::prevWithChips(int seat) const {
+    if (seat < 0) return -1;
+    size_t word = static_cast<size_t>(seat) >> 6;
+    uint64_t bits = this->alive[word] & (~0ULL >> (63 - (seat & 63)));
+    while (bits == 0) {
+        if (word-- == 0) return -1;
+        bits = this->alive[word];
+    }
+    return static_cast<int>(word * 64 + 63 - __builtin_clzll(bits));
+}
+
+inline int GameState::highestTarget(int thief) const {
+    if (this->maxTree[1] == 0) return -1;
+    int top = 0xFFFF - static_cast<int>(this->maxTree[1] & 0xFFFF);
+    if (top != thief) return top;
+
+    // The thief leads: best of the ranges either side of it
+    uint32_t best = 0;
+    for (size_t l = this->leafBase, r = this->leafBase + thief; l < r; l >>= 1, r >>= 1) {
+        if (l & 1) best = std::max(best, this->maxTree[l++]);
+        if (r & 1) best = std::max(best, this->maxTree[--r]);
+    }
+    for (size_t l = this->leafBase + thief + 1, r = 2 * this->leafBase; l < r; l >>= 1, r >>= 1) {
+        if (l & 1) best = std::max(best, this->maxTree[l++]);
+        if (r & 1) best = std::max(best, this->maxTree[--r]);
+    }
+    return best == 0 ? -1 : 0xFFFF - static_cast<int>(best & 0xFFFF);
+}
+
+inline int GameState::lowestTarget(int thief) const {
+    if (this->minTree[1] == UINT32_MAX) return -1;
+    int top = static_cast<int>(this->minTree[1] & 0xFFFF);
+    if (top != thief) return top;
+
+    uint32_t best = UINT32_MAX;
+    for (size_t l = this->leafBase, r = this->leafBase + thief; l < r; l >>= 1, r >>= 1) {
+        if (l & 1) best = std::min(best, this->minTree[l++]);
+        if (r & 1) best = std::min(best, this->minTree[--r]);
+    }
+    for (size_t l = this->leafBase + thief + 1, r = 2 * this->leafBase; l < r; l >>= 1, r >>= 1) {
+        if (l & 1) best = std::min(best, this->minTree[l++]);
+        if (r & 1) best = std::min(best, this->minTree[--r]);
+    }
+    return best == UINT32_MAX ? -1 : static_cast<int>(best & 0xFFFF);
+}
+
+inline int GameState::oppositeTarget(int thief) const {
+    // The search walks outwards from the opposite seat, right before left at each distance,
+    // so the target is whichever of the nearest holders on each side is closer (right on ties).
+    // Both are found a bitmask word at a time.
+    const int n = this->numSeats;
+    const int from = this->opposite[thief];
+
+    int right = nextWithChips(from);
+    if (right == thief) right = nextWithChips(right + 1);
+    if (right >= n) {
+        right = nextWithChips(0);
+        if (right == thief) right = nextWithChips(right + 1);
+        if (right >= from) right = -1; // Wrapped all the way round
+    }
+    if (right < 0) return -1; // Nobody but the thief holds chips
+
+    int left = prevWithChips(from);
+    if (left == thief) left = prevWithChips(left - 1);
+    if (left < 0) {
+        left = prevWithChips(n - 1);
+        if (left == thief) left = prevWithChips(left - 1);
+    }
+
+    int rightDistance = (right - from + n) % n;
+    int leftDistance = (from - left + n) % n;
+    return rightDistance <= leftDistance ? right : left;
+}
+
+inline int GameState::scanTarget(int thief) const {
+    int target = -1;
+
+    switch (this->strategies[thief]) {
+        case Player::PlayStyle::StealFromHighest: {
+            for (int seat = 0; seat < this->numSeats; ++seat) {
+                if (seat == thief || this->chips[seat] == 0) continue;
+                if (target < 0 || this->chips[seat] > this->chips[target]) { target = seat; }
+            }
+            break;
+        }
+        case Player::PlayStyle::StealFromLowest: {
+            for (int seat = 0; seat < this->numSeats; ++seat) {
+                if (seat == thief || this->chips[seat] == 0) continue;
+                if (target < 0 || this->chips[seat] < this->chips[target]) { target = seat; }
+            }
+            break;
+        }
+        case Player::PlayStyle::StealFromOpposite:
+        case Player::PlayStyle::StealOppositeConditional: {
+            int from = this->opposite[thief];
+
+            // Search outwards from the opposite seat, right before left at each distance
+            for (int offset = 0, right = from, left = from; offset <= this->numSeats / 2; ++offset) {
+                if (right != thief && this->chips[right] > 0) return right;
+                if (offset > 0 && left != thief && this->chips[left] > 0) return left;
+                right = rightOf(right);
+                left = leftOf(left);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    return target;
+}
+
+inline bool GameState::attemptSteal(int thief) {
+    int target = -1;
+
+    if (this->numSeats <= LinearScanSeats) {
+        target = scanTarget(thief);
+    } else switch (this->strategies[thief]) {
+        case Player::PlayStyle::StealFromHighest:
+            target = highestTarget(thief);
+            break;
+        case Player::PlayStyle::StealFromLowest:
+            target = lowestTarget(thief);
+            break;
+        case Player::PlayStyle::StealFromOpposite:          // Target finding is the same for both opposite styles
+        case Player::PlayStyle::StealOppositeConditional:
+            target = oppositeTarget(thief);
+            break;
+        default:
+            break;
+    }
+
+    if (target < 0) {
+        return false; // Steal fails if no valid targets
+    }
+
+    removeChips(target, 1);
+    addChips(thief, 1);
+    return true;
+}
+
+#endif //LCR_GAMESTATE_H
@@ -29,7 +29,7 @@ public:
     // Handles wrapping around the circle.
     static int calculateNeededPlayerIndex(int numOfPlayers, int currentIndex, Direction direction);
 
-    static std::string formatWithCommas(int value);
+    static std::string formatWithCommas(long long value);
 };
 
 int Helpers::calculateNeededPlayerIndex(int numOfPlayers, int currentIndex, Helpers::Direction direction) {
@@ -47,7 +47,7 @@ int Helpers::calculateNeededPlayerIndex(int numOfPlayers, int currentIndex, Help
     }
 }
 
-std::string Helpers::formatWithCommas(const int value) {
+std::string Helpers::formatWithCommas(const long long value) {
     std::string number_str = std::to_string(value);
 
     for (int i = number_str.length() - 3; i > 0; i -= 3)
@@ -0,0 +1,224 @@
+// =========================================================================
+// kernel.h
+// =========================================================================
+#ifndef LCR_KERNEL_H
+#define LCR_KERNEL_H
+
+#include <array>
+#include <utility>
+#include <algorithm>
+#include "game.h"
+#include "gameState.h"
+#include "dice.h"
+#include "result.h"
+#include "roundStats.h"
+#include "eventCounters.h"
+
+// Strategy tags for the specialized kernels. A uniform table resolves the wild-cancellation
+// policy at compile time; a mixed table looks it up per seat like the generic engine.
+template <Player::PlayStyle Style>
+struct UniformStrategy {
+    static Player::PlayStyle of(const Player::PlayStyle*, int) { return Style; }
+};
+
+struct MixedStrategy {
+    static Player::PlayStyle of(const Player::PlayStyle* strategies, int seat) { return strategies[seat]; }
+};
+
+// Seat `seat + shift` around a table of NumPlayers, for every seat
+template <int NumPlayers>
+constexpr std::array<int, NumPlayers> rotatedSeats(int shift) {
+    std::array<int, NumPlayers> table{};
+    for (int seat = 0; seat < NumPlayers; ++seat) { table[seat] = (seat + shift) % NumPlayers; }
+    return table;
+}
+
+// Neighbour and opposite seats, resolved at compile time for each table size
+template <int NumPlayers>
+struct KernelSeats {
+    static constexpr std::array<int, NumPlayers> left = rotatedSeats<NumPlayers>(NumPlayers - 1);
+    static constexpr std::array<int, NumPlayers> right = rotatedSeats<NumPlayers>(1);
+    static constexpr std::array<int, NumPlayers> opposite = rotatedSeats<NumPlayers>(NumPlayers / 2);
+};
+
+// Game kernels specialized by table size. Chips live in a local array of NumPlayers ints,
+// neighbour and opposite seats come from constexpr tables, and turn order needs no modulo.
+// They follow the same rules, steal targets and dice consumption as Game::play, so a game
+// gives the same Result on either path.
+class Kernels {
+public:
+    static constexpr int MinSeats = 2;
+    static constexpr int MaxSeats = 16;
+
+    // Plays the dealt game on the kernel for its table size, or on the generic engine
+    // when the table is outside [MinSeats, MaxSeats]. roundStats is as for Game::play.
+    static Result play(int gameId, GameState& state, Rng& rng, RoundStats::Accumulator* roundStats = nullptr);
+
+    template <int NumPlayers, typename Strategy>
+    static Result playKernel(int gameId, GameState& state, Rng& rng, RoundStats::Accumulator* roundStats);
+
+private:
+    using KernelFn = Result (*)(int, GameState&, Rng&, RoundStats::Accumulator*);
+
+    template <int NumPlayers>
+    static Result playSized(int gameId, GameState& state, Rng& rng, RoundStats::Accumulator* roundStats);
+
+    template <int... Offsets>
+    static constexpr std::array<KernelFn, sizeof...(Offsets)> sizedTable(std::integer_sequence<int, Offsets...>) {
+        return {&playSized<MinSeats + Offsets>...};
+    }
+
+    template <int NumPlayers>
+    static int findTarget(const int* chips, int thief, Player::PlayStyle style);
+};
+
+inline Result Kernels::play(int gameId, GameState& state, Rng& rng, RoundStats::Accumulator* roundStats) {
+    static constexpr auto table = sizedTable(std::make_integer_sequence<int, MaxSeats - MinSeats + 1>{});
+    int numSeats = state.getNumSeats();
+    if (numSeats < MinSeats || numSeats > MaxSeats) {
+        Game game(state);
+        return game.play(gameId, rng, nullptr, roundStats);
+    }
+    return table[numSeats - MinSeats](gameId, state, rng, roundStats);
+}
+
+template <int NumPlayers>
+Result Kernels::playSized(int gameId, GameState& state, Rng& rng, RoundStats::Accumulator* roundStats) {
+    Player::PlayStyle first = state.getStrategy(0);
+    for (int seat = 1; seat < NumPlayers; ++seat) {
+        if (state.getStrategy(seat) != first) {
+            return playKernel<NumPlayers, MixedStrategy>(gameId, state, rng, roundStats);
+        }
+    }
+    switch (first) {
+        case Player::PlayStyle::StealFromHighest:
+            return playKernel<NumPlayers, UniformStrategy<Player::PlayStyle::StealFromHighest>>(gameId, state, rng, roundStats);
+        case Player::PlayStyle::StealFromLowest:
+            return playKernel<NumPlayers, UniformStrategy<Player::PlayStyle::StealFromLowest>>(gameId, state, rng, roundStats);
+        case Player::PlayStyle::StealFromOpposite:
+            return playKernel<NumPlayers, UniformStrategy<Player::PlayStyle::StealFromOpposite>>(gameId, state, rng, roundStats);
+        case Player::PlayStyle::StealOppositeConditional:
+            return playKernel<NumPlayers, UniformStrategy<Player::PlayStyle::StealOppositeConditional>>(gameId, state, rng, roundStats);
+        default:
+            return playKernel<NumPlayers, MixedStrategy>(gameId, state, rng, roundStats);
+    }
+}
+
+// Same targets as GameState::scanTarget: highest / lowest with ties to the lowest seat,
+// opposite searching outwards with right before left
+template <int NumPlayers>
+int Kernels::findTarget(const int* chips, int thief, Player::PlayStyle style) {
+    int target = -1;
+    switch (style) {
+        case Player::PlayStyle::StealFromHighest:
+            for (int seat = 0; seat < NumPlayers; ++seat) {
+                if (seat == thief || chips[seat] == 0) continue;
+                if (target < 0 || chips[seat] > chips[target]) { target = seat; }
+            }
+            break;
+        case Player::PlayStyle::StealFromLowest:
+            for (int seat = 0; seat < NumPlayers; ++seat) {
+                if (seat == thief || chips[seat] == 0) continue;
+                if (target < 0 || chips[seat] < chips[target]) { target = seat; }
+            }
+            break;
+        case Player::PlayStyle::StealFromOpposite:
+        case Player::PlayStyle::StealOppositeConditional: {
+            int from = KernelSeats<NumPlayers>::opposite[thief];
+            for (int offset = 0, right = from, left = from; offset <= NumPlayers / 2; ++offset) {
+                if (right != thief && chips[right] > 0) return right;
+                if (offset > 0 && left != thief && chips[left] > 0) return left;
+                right = KernelSeats<NumPlayers>::right[right];
+                left = KernelSeats<NumPlayers>::left[left];
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return target;
+}
+
+template <int NumPlayers, typename Strategy>
+Result Kernels::playKernel(int gameId, GameState& state, Rng& rng, RoundStats::Accumulator* roundStats) {
+    static_assert(NumPlayers >= MinSeats, "A game needs at least two players");
+    using Seat = KernelSeats<NumPlayers>;
+
+    int chips[NumPlayers];
+    Player::PlayStyle strategies[NumPlayers];
+    int playersWithChips = 0;
+    for (int seat = 0; seat < NumPlayers; ++seat) {
+        chips[seat] = state.getChips(seat);
+        strategies[seat] = state.getStrategy(seat);
+        playersWithChips += chips[seat] > 0;
+    }
+
+    auto give = [&](int seat, int num) {
+        if (chips[seat] == 0) playersWithChips++;
+        chips[seat] += num;
+    };
+    auto finish = [&]() {
+        for (int seat = 0; seat < NumPlayers; ++seat) { state.setChips(seat, chips[seat]); }
+    };
+
+    const int startSeat = state.getStartSeat();
+    int round = 0;
+    while (playersWithChips >= 1) {
+        round++;
+
+        for (int turn = 0; turn < NumPlayers; ++turn) {
+            int seat = startSeat + turn;
+            if (seat >= NumPlayers) seat -= NumPlayers;
+
+            int available = chips[seat];
+            if (available == 0) continue;
+
+            Dice::Roll roll = Dice::rollTurn(std::min(available, Dice::MaxDicePerTurn), rng.next());
+            const Player::PlayStyle style = Strategy::of(strategies, seat);
+            EventCounters::turn(style, roll);
+
+            if (playersWithChips == 1 && roll.onlyDotsOrWilds()) {
+                if (roundStats) { roundStats->add(round, chips, NumPlayers); }
+                finish();
+                return Result(gameId, seat, strategies[seat], round, NumPlayers, state.getInitialChips(), state.getAssignment());
+            }
+
+            if (playersWithChips == 1) { EventCounters::add(style, EventCounters::LastPlayerRetries); }
+
+            const Game::Moves moves = Game::resolveRoll(style, roll);
+            EventCounters::cancellations(style, roll, moves);
+
+            int removed = 0;
+            int actualPassLeft = std::min(moves.passLeft, available - removed);
+            if (actualPassLeft > 0) { give(Seat::left[seat], actualPassLeft); removed += actualPassLeft; }
+            int actualToPot = std::min(moves.toPot, available - removed);
+            if (actualToPot > 0) { state.addToPot(actualToPot); removed += actualToPot; }
+            int actualPassRight = std::min(moves.passRight, available - removed);
+            if (actualPassRight > 0) { give(Seat::right[seat], actualPassRight); removed += actualPassRight; }
+
+            if (removed > 0) {
+                chips[seat] -= removed;
+                if (chips[seat] == 0) playersWithChips--;
+            }
+
+            for (int k = 0; k < moves.steals; ++k) {
+                int target = findTarget<NumPlayers>(chips, seat, style);
+                if (target < 0) { // Nobody left to steal from; later attempts fail too
+                    EventCounters::add(style, EventCounters::FailedSteals, moves.steals - k);
+                    break;
+                }
+                if (--chips[target] == 0) playersWithChips--;
+                give(seat, 1);
+                EventCounters::add(style, EventCounters::Steals);
+            }
+        }
+
+        if (roundStats) { roundStats->add(round, chips, NumPlayers); }
+    }
+
+    // Draw: every chip went to the pot
+    finish();
+    return Result(gameId, Result::NoWinner, strategies[0], round, NumPlayers, state.getInitialChips(), state.getAssignment(), true);
+}
+
+#endif //LCR_KERNEL_H
@@ -0,0 +1,137 @@
+// =========================================================================
+// lengthHistogram.h
+// =========================================================================
+#ifndef LCR_LENGTHHISTOGRAM_H
+#define LCR_LENGTHHISTOGRAM_H
+
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include "player.h"
+#include "result.h"
+
+// Game lengths in rounds, split by winning strategy and draws. Lengths below ExactBuckets get
+// a bucket each; longer ones are log-bucketed with SubBuckets buckets per power of two, so a
+// bucket is never wider than 1/16 of its lower bound. Each worker fills its own counts, which
+// are merged once the run is over.
+class LengthHistogram {
+public:
+    static constexpr int NumStrategies = Player::PlayStyle::StealOppositeConditional + 1;
+    static constexpr int DrawGroup = NumStrategies;  // Groups are the winning strategies, then draws
+    static constexpr int Groups = NumStrategies + 1;
+
+    static constexpr int ExactBits = 6;
+    static constexpr int SubBits = 4;
+    static constexpr int ExactBuckets = 1 << ExactBits;
+    static constexpr int SubBuckets = 1 << SubBits;
+    static constexpr int Buckets = ExactBuckets + (31 - ExactBits) * SubBuckets; // Up to INT_MAX rounds
+
+    // One group's merged counts
+    struct Series {
+        std::vector<uint64_t> counts = std::vector<uint64_t>(Buckets, 0);
+        uint64_t games = 0;
+        int longest = 0;
+
+        void add(const Series& other);
+        // Upper bound of the bucket holding the q-quantile (exact below ExactBuckets), at most `longest`
+        int quantile(double q) const;
+    };
+
+    explicit LengthHistogram(int numWorkers);
+
+    static int bucketOf(int rounds);
+    static int bucketLow(int bucket);
+    static int bucketHigh(int bucket);
+
+    // Counts a finished game for `worker` (0 <= worker < numWorkers)
+    void add(int worker, const Result& result) {
+        Slot& slot = *this->slots[worker];
+        const int group = result.draw ? DrawGroup : static_cast<int>(result.winnerStrategy);
+        slot.counts[group][bucketOf(result.numberOfRounds)]++;
+        slot.longest[group] = std::max(slot.longest[group], result.numberOfRounds);
+    }
+
+    // Per group; call once the workers have stopped
+    std::vector<Series> merge() const;
+
+    // Adds earlier per-group counts (a checkpoint's) to worker 0; call before the workers start
+    void restore(const std::vector<Series>& series);
+
+private:
+    struct alignas(64) Slot {
+        uint64_t counts[Groups][Buckets] = {};
+        int longest[Groups] = {};
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots;
+};
+
+inline LengthHistogram::LengthHistogram(int numWorkers) {
+    for (int worker = 0; worker < numWorkers; ++worker) {
+        this->slots.push_back(std::make_unique<Slot>());
+    }
+}
+
+inline int LengthHistogram::bucketOf(int rounds) {
+    if (rounds < ExactBuckets) return std::max(rounds, 0);
+    const int exponent = 31 - __builtin_clz(static_cast<unsigned>(rounds)); // >= ExactBits
+    const int sub = (rounds >> (exponent - SubBits)) & (SubBuckets - 1);
+    return ExactBuckets + (exponent - ExactBits) * SubBuckets + sub;
+}
+
+inline int LengthHistogram::bucketLow(int bucket) {
+    if (bucket < ExactBuckets) return bucket;
+    const int exponent = ExactBits + (bucket - ExactBuckets) / SubBuckets;
+    const int sub = (bucket - ExactBuckets) % SubBuckets;
+    return static_cast<int>((static_cast<int64_t>(SubBuckets + sub)) << (exponent - SubBits));
+}
+
+inline int LengthHistogram::bucketHigh(int bucket) {
+    if (bucket < ExactBuckets) return bucket;
+    const int exponent = ExactBits + (bucket - ExactBuckets) / SubBuckets;
+    return static_cast<int>(std::min<int64_t>(static_cast<int64_t>(bucketLow(bucket)) + (int64_t{1} << (exponent - SubBits)) - 1, INT32_MAX));
+}
+
+inline void LengthHistogram::Series::add(const Series& other) {
+    for (int bucket = 0; bucket < Buckets; ++bucket) { this->counts[bucket] += other.counts[bucket]; }
+    this->games += other.games;
+    this->longest = std::max(this->longest, other.longest);
+}
+
+inline int LengthHistogram::Series::quantile(double q) const {
+    if (this->games == 0) return 0;
+    // Rank of the quantile among the games, 1-based
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(this->games))));
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < Buckets; ++bucket) {
+        seen += this->counts[bucket];
+        if (seen >= rank) return std::min(bucketHigh(bucket), this->longest);
+    }
+    return this->longest;
+}
+
+inline std::vector<LengthHistogram::Series> LengthHistogram::merge() const {
+    std::vector<Series> series(Groups);
+    for (const auto& slot : this->slots) {
+        for (int group = 0; group < Groups; ++group) {
+            for (int bucket = 0; bucket < Buckets; ++bucket) {
+                series[group].counts[bucket] += slot->counts[group][bucket];
+                series[group].games += slot->counts[group][bucket];
+            }
+            series[group].longest = std::max(series[group].longest, slot->longest[group]);
+        }
+    }
+    return series;
+}
+
+inline void LengthHistogram::restore(const std::vector<Series>& series) {
+    Slot& slot = *this->slots[0];
+    for (int group = 0; group < Groups && group < static_cast<int>(series.size()); ++group) {
+        for (int bucket = 0; bucket < Buckets; ++bucket) { slot.counts[group][bucket] += series[group].counts[bucket]; }
+        slot.longest[group] = std::max(slot.longest[group], series[group].longest);
+    }
+}
+
+#endif //LCR_LENGTHHISTOGRAM_H
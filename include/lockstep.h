@@ -0,0 +1,450 @@
+// =========================================================================
+// lockstep.h
+// =========================================================================
+#ifndef LCR_LOCKSTEP_H
+#define LCR_LOCKSTEP_H
+
+#include <array>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include "game.h"
+#include "kernel.h"
+#include "gameState.h"
+#include "dice.h"
+#include "rng.h"
+#include "result.h"
+#include "roundStats.h"
+#include "eventCounters.h"
+
+// Plays a range of games Lanes at a time in lockstep: every step gives each lane one turn of
+// its own game. The lanes' tables are held seat-major, one vector of Lanes chip counts per
+// seat, and a step is the same sequence of vector operations whatever the dice say: the
+// roller's chips, the transfers, the steal targets and the next seat to roll are masked
+// arithmetic over the seats, so no lane's roll steers a branch. Only the alias-table lookup
+// of each lane's roll and the bookkeeping of a finished game go lane by lane. A lane whose
+// game ends is refilled with the next game id straight away.
+// Every game draws from its own Rng(seed, gameId) stream exactly as Game::play would, so the
+// Results are identical to the other engines'.
+// The steps are built for AVX2; split over narrower registers they lose to the kernels, so on
+// CPUs without AVX2, and for tables outside [MinSeats, MaxSeats], games are played one at a
+// time on Kernels::play.
+// There is no 16-lane AVX-512 form: built for AVX-512 with 16 lanes, the same steps ran at about
+// half the speed of the 8 AVX2 lanes.
+class LockstepEngine {
+public:
+    static constexpr int Lanes = 8;
+    static constexpr int MinSeats = Kernels::MinSeats;
+    static constexpr int MaxSeats = Kernels::MaxSeats;
+
+    // What a lane needs to deal a game: the batch's concrete strategies (which must outlive
+    // the Result) and the seat that rolls first
+    struct Deal {
+        const std::vector<Player::PlayStyle>* strategies;
+        int startSeat;
+    };
+
+    // Plays games [firstGame, lastGame). `deal(gameId)` returns the game's Deal and
+    // `emit(const Result&)` receives every Result, in completion order. roundStats is as for Game::play.
+    // Once `cancel` is set no further games are dealt and the lanes' games are played out.
+    // Returns the end of the games played: [firstGame, return value) all finished.
+    template <typename DealFn, typename EmitFn>
+    int play(const Roster& roster, uint64_t seed, int firstGame, int lastGame, DealFn&& deal, EmitFn&& emit,
+             RoundStats::Accumulator* roundStats = nullptr, const std::atomic<bool>* cancel = nullptr);
+
+private:
+    // One value per lane. Comparisons give -1 in the lanes where they hold and 0 elsewhere.
+    typedef int32_t Lane __attribute__((vector_size(Lanes * sizeof(int32_t))));
+    typedef uint64_t LaneWord __attribute__((vector_size(Lanes * sizeof(uint64_t))));
+
+    // Steal and turn-order keys: a rank above the seat in the low SeatBits, smallest wins
+    static constexpr int SeatBits = 5;
+    static constexpr int32_t NoSeat = INT32_MAX;
+    static_assert(MaxSeats <= (1 << SeatBits), "Seats must fit the low bits of a key");
+    static constexpr int32_t MaxChips = UINT16_MAX; // Seats hold their chips as uint16_t
+    static_assert(MaxChips < (1 << (31 - SeatBits)), "Chip counts must fit above the seat in a key");
+
+    // Concrete strategies; Random is resolved per batch before a game is dealt
+    static constexpr int NumStyles = Player::PlayStyle::StealOppositeConditional + 1;
+
+    // Plays steps until a lane's game ends; returns the finished lanes as a bit mask
+    using StepFn = uint32_t (*)(LockstepEngine&);
+
+    // The steps for a table of numSeats, or nullptr where the lanes don't pay
+    static StepFn stepFunction(int numSeats);
+
+    template <int NumPlayers>
+    __attribute__((always_inline)) inline uint32_t steps();
+
+#if defined(__x86_64__) || defined(__i386__)
+    template <int NumPlayers>
+    __attribute__((target("avx2"))) static uint32_t stepsAvx2(LockstepEngine& engine) { return engine.steps<NumPlayers>(); }
+
+    template <int... Offsets>
+    static constexpr std::array<StepFn, sizeof...(Offsets)> avx2Table(std::integer_sequence<int, Offsets...>) {
+        return {&stepsAvx2<MinSeats + Offsets>...};
+    }
+#endif
+
+    // Chips moved by every roll for a roller of each strategy, from Game::resolveRoll:
+    // passLeft | toPot << 2 | passRight << 4 | steals << 6, indexed by the roll's face counts
+    static const std::array<std::array<uint8_t, 1 << 10>, NumStyles>& movesTable();
+
+    // Deals `gameId` into `lane`; returns false (leaving the lane idle) if the table has no chips,
+    // in which case `result` holds the game's immediate draw
+    bool dealLane(int lane, int gameId, const Deal& dealt, Result& result);
+
+    // The Result of the game that just ended in `lane`; also adds its last round to roundStats
+    Result finishLane(int lane);
+
+    // Chips of one lane's table, for roundStats
+    void laneChips(int lane, int* out) const;
+
+    // Vectors go by reference: a 32-byte vector passed by value has a different calling
+    // convention with and without AVX
+    static bool any(const Lane& mask) {
+        uint64_t halves[Lanes / 2];
+        std::memcpy(halves, &mask, sizeof(mask));
+        uint64_t bits = 0;
+        for (uint64_t half : halves) { bits |= half; }
+        return bits != 0;
+    }
+    static uint32_t bitsOf(const Lane& mask) {
+        uint32_t bits = 0;
+        for (int lane = 0; lane < Lanes; ++lane) { bits |= static_cast<uint32_t>(mask[lane] != 0) << lane; }
+        return bits;
+    }
+
+    int numSeats = 0;
+    int initialChips = 0;
+    const Roster* roster = nullptr;
+    uint64_t seed = 0;
+    RoundStats::Accumulator* roundStats = nullptr;
+
+    // Every lane's game, seat-major: chips[seat][lane]. A lane is idle while `active` is 0 in it.
+    Lane chips[MaxSeats] = {};
+    Lane strategies[MaxSeats] = {};
+    Lane seat = {};             // The seat about to roll
+    Lane startSeat = {};
+    Lane round = {};
+    Lane alive = {};            // Seats holding chips
+    Lane active = {};
+    Lane won = {};              // Set by steps() in lanes whose game just ended
+    Lane drawn = {};
+    LaneWord keys = {};         // Each lane's Rng stream
+    LaneWord counters = {};
+
+    int gameIds[Lanes] = {};
+    const std::vector<Player::PlayStyle>* assignments[Lanes] = {};
+};
+
+template <typename DealFn, typename EmitFn>
+int LockstepEngine::play(const Roster& roster, uint64_t seed, int firstGame, int lastGame, DealFn&& deal, EmitFn&& emit,
+                         RoundStats::Accumulator* roundStats, const std::atomic<bool>* cancel) {
+    this->roster = &roster;
+    this->seed = seed;
+    this->roundStats = roundStats;
+    this->numSeats = roster.size();
+    this->initialChips = roster.startingChips(0);
+
+    StepFn step = stepFunction(this->numSeats);
+    if (!step) {
+        // No lanes for this table size or CPU
+        thread_local GameState state;
+        for (int gameId = firstGame; gameId < lastGame; ++gameId) {
+            if (cancel && cancel->load(std::memory_order_relaxed)) return gameId;
+            const Deal dealt = deal(gameId);
+            state.reset(roster, *dealt.strategies, dealt.startSeat);
+            Rng rng(seed, static_cast<uint64_t>(gameId));
+            emit(static_cast<const Result&>(Kernels::play(gameId, state, rng, roundStats)));
+        }
+        return lastGame;
+    }
+
+    for (Lane& seatChips : this->chips) { seatChips = Lane{}; }
+    this->active = Lane{};
+
+    int nextGame = firstGame;
+    int running = 0;
+    Result result;
+
+    // Fill a lane with the next game that actually has turns to play
+    auto refill = [&](int lane) {
+        while (nextGame < lastGame && !(cancel && cancel->load(std::memory_order_relaxed))) {
+            int gameId = nextGame++;
+            if (this->dealLane(lane, gameId, deal(gameId), result)) {
+                return true;
+            }
+            emit(static_cast<const Result&>(result));
+        }
+        this->active[lane] = 0;
+        for (Lane& seatChips : this->chips) { seatChips[lane] = 0; }
+        return false;
+    };
+
+    for (int lane = 0; lane < Lanes; ++lane) {
+        if (refill(lane)) running++;
+    }
+
+    while (running > 0) {
+        for (uint32_t finished = step(*this); finished != 0; finished &= finished - 1) {
+            const int lane = __builtin_ctz(finished);
+            emit(static_cast<const Result&>(finishLane(lane)));
+            if (!refill(lane)) running--;
+        }
+    }
+    return nextGame;
+}
+
+inline LockstepEngine::StepFn LockstepEngine::stepFunction(int numSeats) {
+    if (numSeats < MinSeats || numSeats > MaxSeats) return nullptr;
+#if defined(__x86_64__) || defined(__i386__)
+    static constexpr auto avx2 = avx2Table(std::make_integer_sequence<int, MaxSeats - MinSeats + 1>{});
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    if (hasAvx2) return avx2[numSeats - MinSeats];
+#endif
+    return nullptr;
+}
+
+inline const std::array<std::array<uint8_t, 1 << 10>, LockstepEngine::NumStyles>& LockstepEngine::movesTable() {
+    static const auto table = []() {
+        std::array<std::array<uint8_t, 1 << 10>, NumStyles> moves{};
+        for (int numDice = 1; numDice <= Dice::MaxDicePerTurn; ++numDice) {
+            for (const auto& outcome : Dice::outcomeWeights(numDice)) {
+                const Dice::Roll roll{outcome.first};
+                for (int style = 0; style < NumStyles; ++style) {
+                    const Game::Moves m = Game::resolveRoll(static_cast<Player::PlayStyle>(style), roll);
+                    moves[style][roll.packed & 0x3FF] = static_cast<uint8_t>(m.passLeft | m.toPot << 2 | m.passRight << 4 | m.steals << 6);
+                }
+            }
+        }
+        return moves;
+    }();
+    return table;
+}
+
+template <int NumPlayers>
+inline uint32_t LockstepEngine::steps() {
+    const auto& moveTable = movesTable();
+
+    Lane chips[NumPlayers];
+    Lane strategies[NumPlayers];
+    for (int s = 0; s < NumPlayers; ++s) {
+        chips[s] = this->chips[s];
+        strategies[s] = this->strategies[s];
+    }
+    Lane seat = this->seat;
+    Lane round = this->round;
+    Lane alive = this->alive;
+    const Lane startSeat = this->startSeat;
+    const Lane active = this->active;
+    const LaneWord keys = this->keys;
+    LaneWord counters = this->counters;
+
+    const Lane one = Lane{} + 1;
+    const Lane maxDice = Lane{} + Dice::MaxDicePerTurn;
+    const Lane noSeat = Lane{} + NoSeat;
+
+    while (true) {
+        // Every lane's next word, as Rng::next
+        counters += 1;
+        LaneWord words = keys + counters * Rng::Gamma;
+        Rng::mixWords(words);
+
+        // The roller's chips and strategy
+        Lane isRoller[NumPlayers];
+        Lane available = {};
+        Lane style = {};
+        for (int s = 0; s < NumPlayers; ++s) {
+            isRoller[s] = seat == s;
+            available |= isRoller[s] & chips[s];
+            style |= isRoller[s] & strategies[s];
+        }
+        Lane numDice = available < maxDice ? available : maxDice;
+        numDice = numDice > 0 ? numDice : one; // Idle lanes roll a die that is never used
+
+        // The lanes' rolls and the chips each moves
+        alignas(64) uint64_t laneWords[Lanes];
+        alignas(32) int32_t laneDice[Lanes], laneStyles[Lanes], laneRolls[Lanes], laneMoves[Lanes];
+        std::memcpy(laneWords, &words, sizeof(words));
+        std::memcpy(laneDice, &numDice, sizeof(numDice));
+        std::memcpy(laneStyles, &style, sizeof(style));
+        for (int lane = 0; lane < Lanes; ++lane) {
+            const Dice::Roll roll = Dice::rollTurn(laneDice[lane], laneWords[lane]);
+            laneRolls[lane] = roll.packed;
+            laneMoves[lane] = moveTable[laneStyles[lane]][roll.packed & 0x3FF];
+        }
+        Lane rolls, moves;
+        std::memcpy(&rolls, laneRolls, sizeof(rolls));
+        std::memcpy(&moves, laneMoves, sizeof(moves));
+
+        // The last player holding chips wins on a roll of only dots and wilds
+        const Lane won = active & (alive == 1) & ((rolls & Dice::DotsOrWildsFlag) != 0);
+        const Lane playing = active & ~won;
+        moves &= playing;
+        const Lane passLeft = moves & 3;
+        const Lane toPot = (moves >> 2) & 3;
+        const Lane passRight = (moves >> 4) & 3;
+        const Lane steals = (moves >> 6) & 3;
+
+        // A roll moves at most one chip per die and nobody rolls more dice than chips held, so
+        // the transfers never need capping. Seat s is left of the roller when the roller sits at s + 1.
+        const Lane removed = passLeft + toPot + passRight;
+        for (int s = 0; s < NumPlayers; ++s) {
+            chips[s] += (isRoller[(s + 1) % NumPlayers] & passLeft) + (isRoller[(s + NumPlayers - 1) % NumPlayers] & passRight) -
+                        (isRoller[s] & removed);
+        }
+
+        // Steals one wild at a time, each on the table the previous one left. The target is the
+        // seat with the smallest key among the others holding chips: fewest chips from the top
+        // (highest), fewest chips (lowest), or search order out from the opposite seat, right
+        // before left at each distance (opposite styles); ties go to the lowest seat.
+        Lane stolen = {};
+        if (any(steals > 0)) {
+            const Lane isHighest = style == static_cast<int32_t>(Player::PlayStyle::StealFromHighest);
+            const Lane isLowest = style == static_cast<int32_t>(Player::PlayStyle::StealFromLowest);
+            Lane from = seat + NumPlayers / 2;
+            from -= (from >= NumPlayers) & NumPlayers;
+            Lane searchKeys[NumPlayers];
+            for (int s = 0; s < NumPlayers; ++s) {
+                Lane rightDistance = s - from;
+                rightDistance += (rightDistance < 0) & NumPlayers;
+                const Lane order = rightDistance <= NumPlayers / 2 ? rightDistance * 2 : (NumPlayers - rightDistance) * 2 + 1;
+                searchKeys[s] = (order << SeatBits) | s;
+            }
+            for (int k = 0; k < Dice::MaxDicePerTurn; ++k) {
+                const Lane stealing = steals > k;
+                if (!any(stealing)) break;
+                Lane best = noSeat;
+                for (int s = 0; s < NumPlayers; ++s) {
+                    const Lane byChips = isHighest ? MaxChips - chips[s] : chips[s];
+                    Lane key = (isHighest | isLowest) ? (byChips << SeatBits) | s : searchKeys[s];
+                    key = (chips[s] > 0) & ~isRoller[s] ? key : noSeat;
+                    best = key < best ? key : best;
+                }
+                const Lane found = stealing & (best != NoSeat);
+                const Lane target = best & ((1 << SeatBits) - 1);
+                for (int s = 0; s < NumPlayers; ++s) {
+                    chips[s] += (found & (target == s)) - (found & isRoller[s]); // Masks are -1
+                }
+                stolen -= found;
+            }
+        }
+
+        Lane holders = {};
+        for (int s = 0; s < NumPlayers; ++s) { holders -= chips[s] > 0; }
+        const Lane aliveBefore = alive;
+        alive = playing ? holders : alive;
+        const Lane drawn = playing & (holders == 0);
+
+        // Next seat holding chips in turn order from the starter: later in this round if there
+        // is one, otherwise the first of the next round
+        Lane position = seat - startSeat;
+        position += (position < 0) & NumPlayers;
+        Lane next = noSeat;
+        for (int s = 0; s < NumPlayers; ++s) {
+            Lane order = s - startSeat;
+            order += (order < 0) & NumPlayers;
+            order += (order <= position) & NumPlayers;
+            const Lane key = chips[s] > 0 ? (order << SeatBits) | s : noSeat;
+            next = key < next ? key : next;
+        }
+        const Lane moving = playing & ~drawn;
+        const Lane roundEnded = moving & ((next >> SeatBits) >= NumPlayers);
+        seat = moving ? next & ((1 << SeatBits) - 1) : seat;
+
+        if constexpr (EventCounters::Enabled) {
+            for (int lane = 0; lane < Lanes; ++lane) {
+                if (!active[lane]) continue;
+                const Player::PlayStyle laneStyle = static_cast<Player::PlayStyle>(laneStyles[lane]);
+                const Dice::Roll roll{static_cast<uint16_t>(laneRolls[lane])};
+                EventCounters::turn(laneStyle, roll);
+                if (won[lane]) continue;
+                if (aliveBefore[lane] == 1) { EventCounters::add(laneStyle, EventCounters::LastPlayerRetries); }
+                EventCounters::cancellations(laneStyle, roll, Game::Moves{passLeft[lane], toPot[lane], passRight[lane], steals[lane]});
+                EventCounters::add(laneStyle, EventCounters::Steals, static_cast<uint64_t>(stolen[lane]));
+                EventCounters::add(laneStyle, EventCounters::FailedSteals, static_cast<uint64_t>(steals[lane] - stolen[lane]));
+            }
+        }
+
+        if (this->roundStats && any(roundEnded)) {
+            for (int lane = 0; lane < Lanes; ++lane) {
+                if (!roundEnded[lane]) continue;
+                int table[NumPlayers];
+                for (int s = 0; s < NumPlayers; ++s) { table[s] = chips[s][lane]; }
+                this->roundStats->add(round[lane], table, NumPlayers);
+            }
+        }
+        round -= roundEnded;
+
+        const Lane finished = won | drawn;
+        if (any(finished)) {
+            for (int s = 0; s < NumPlayers; ++s) { this->chips[s] = chips[s]; }
+            this->seat = seat;
+            this->round = round;
+            this->alive = alive;
+            this->counters = counters;
+            this->won = won;
+            this->drawn = drawn;
+            return bitsOf(finished);
+        }
+    }
+}
+
+inline bool LockstepEngine::dealLane(int lane, int gameId, const Deal& dealt, Result& result) {
+    // The lane steps the game's own stream, from its start
+    const Rng stream(this->seed, static_cast<uint64_t>(gameId));
+    this->keys[lane] = stream.streamKey();
+    this->counters[lane] = stream.position();
+
+    this->gameIds[lane] = gameId;
+    this->assignments[lane] = dealt.strategies;
+    this->startSeat[lane] = dealt.startSeat;
+
+    int holders = 0;
+    for (int s = 0; s < this->numSeats; ++s) {
+        this->chips[s][lane] = this->roster->startingChips(s);
+        this->strategies[s][lane] = (*dealt.strategies)[s];
+        holders += this->roster->startingChips(s) > 0;
+    }
+    this->alive[lane] = holders;
+
+    if (holders == 0) {
+        // Game::play never enters its loop
+        result = Result(gameId, Result::NoWinner, (*dealt.strategies)[0], 0, this->numSeats, this->initialChips, dealt.strategies, true);
+        this->active[lane] = 0;
+        return false;
+    }
+
+    // First seat with chips, going round from the starter
+    int first = dealt.startSeat;
+    while (this->roster->startingChips(first) == 0) { first = first + 1 == this->numSeats ? 0 : first + 1; }
+    this->seat[lane] = first;
+    this->round[lane] = 1;
+    this->active[lane] = -1;
+    return true;
+}
+
+inline Result LockstepEngine::finishLane(int lane) {
+    const std::vector<Player::PlayStyle>& strategies = *this->assignments[lane];
+    const int round = this->round[lane];
+    if (this->roundStats) {
+        // The table where the game ended; for a draw, the end of its last round
+        int table[MaxSeats];
+        laneChips(lane, table);
+        this->roundStats->add(round, table, this->numSeats);
+    }
+    if (this->won[lane]) {
+        const int winner = this->seat[lane];
+        return Result(this->gameIds[lane], winner, strategies[winner], round, this->numSeats, this->initialChips, &strategies);
+    }
+    return Result(this->gameIds[lane], Result::NoWinner, strategies[0], round, this->numSeats, this->initialChips, &strategies, true);
+}
+
+inline void LockstepEngine::laneChips(int lane, int* out) const {
+    for (int s = 0; s < this->numSeats; ++s) { out[s] = this->chips[s][lane]; }
+}
+
+#endif //LCR_LOCKSTEP_H
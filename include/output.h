@@ -5,25 +5,176 @@
 #ifndef LCR_OUTPUT_H
 #define LCR_OUTPUT_H
 
+#include <string>
+#include <vector>
+#include <ostream>
+#include <algorithm>
 #include "json.hpp"
+#include "player.h"
+#include "gameState.h"
+#include "resultSink.h"
+#include "asyncWriter.h"
+#include "chipHistory.h"
 
 class Output {
 public:
     enum OutputType {
         All,
         Totals,
+        Binary, // Columnar .lcrb file, see binaryOutput.h; convert with lcr-dump
     };
 
     static OutputType stringToOutputType(const std::string& str) {
         if (str == "All") return OutputType::All;
         if (str == "Totals") return OutputType::Totals;
+        if (str == "Binary") return OutputType::Binary;
         return OutputType::All; // Default
     }
 };
 
+// Writes the per-game rows of the All CSV as the records stream in. Rows are formatted with
+// std::to_chars into large buffers that an AsyncWriter writes out while the next ones fill.
+class CsvRecordWriter : public RecordWriter {
+public:
+    static constexpr const char* Header = "gameId,winnerName,winnerStrategy,numberOfRounds,numberOfPlayers,initialChipsPerPlayer";
+
+    CsvRecordWriter(std::ostream& out, const Roster& roster);
+
+    void write(int worker, const GameRecord* records, size_t count) override;
+    void finish() override { this->out.finish(); }
+
+private:
+    AsyncWriter out;
+    std::vector<std::string> names;      // Per seat, "DRAW" after the last seat
+    std::vector<std::string> strategies; // Per PlayStyle value
+    std::string tail;                    // ",numberOfPlayers,initialChipsPerPlayer\n"
+    size_t longestRow;                   // Upper bound on a row's length
+};
+
+// Writes lcr_simulation_results.json: an array with one object per game, in the shape of
+// to_json(Result) plus the batch id, streamed the same way as the CSV. Games with a recorded
+// history also get a "chipHistory" array of per-turn chip counts for visualize_heatmap.py.
+class JsonRecordWriter : public RecordWriter {
+public:
+    // `batches` supplies each game's seat strategies; `histories` may be null when no chip
+    // histories are recorded
+    JsonRecordWriter(std::ostream& out, const Roster& roster, const BatchTable& batches,
+                     ChipHistoryStore* histories = nullptr);
+
+    void write(int worker, const GameRecord* records, size_t count) override;
+    void finish() override;
+
+private:
+    AsyncWriter out;
+    const BatchTable& batches;
+    ChipHistoryStore* histories;         // Histories are taken out as their rows are written
+    std::vector<std::string> strategies; // Per PlayStyle value, quoted
+    std::string tail;                    // The fields that are the same for every game
+    bool first = true;
+};
+
+inline CsvRecordWriter::CsvRecordWriter(std::ostream& out, const Roster& roster) : out(out) {
+    size_t longestName = 4;
+    for (int seat = 0; seat < roster.size(); ++seat) {
+        this->names.push_back(roster.name(seat));
+        longestName = std::max(longestName, roster.name(seat).size());
+    }
+    this->names.push_back("DRAW");
+    for (int style = 0; style <= Player::PlayStyle::Random; ++style) {
+        this->strategies.push_back(Player::playStyleToString(static_cast<Player::PlayStyle>(style)));
+    }
+    this->tail = "," + std::to_string(roster.size()) + "," + std::to_string(roster.startingChips(0)) + "\n";
+    this->longestRow = 2 * 20 + longestName + 32 + this->tail.size();
+}
+
+inline void CsvRecordWriter::write(int, const GameRecord* records, size_t count) {
+    const int drawIndex = static_cast<int>(this->names.size()) - 1;
+    for (size_t k = 0; k < count; ++k) {
+        const GameRecord& record = records[k];
+        char* at = this->out.reserve(this->longestRow);
+        at = AsyncWriter::put(at, record.gameId);
+        *at++ = ',';
+        at = AsyncWriter::put(at, this->names[record.draw ? drawIndex : record.winnerSeat]);
+        *at++ = ',';
+        at = AsyncWriter::put(at, this->strategies[std::min<int>(record.winnerStrategy, Player::PlayStyle::Random)]);
+        *at++ = ',';
+        at = AsyncWriter::put(at, record.rounds);
+        at = AsyncWriter::put(at, this->tail);
+        this->out.commit(at);
+    }
+}
+
+inline JsonRecordWriter::JsonRecordWriter(std::ostream& out, const Roster& roster, const BatchTable& batches,
+                                          ChipHistoryStore* histories)
+        : out(out), batches(batches), histories(histories) {
+    for (int style = 0; style <= Player::PlayStyle::Random; ++style) {
+        this->strategies.push_back("\"" + Player::playStyleToString(static_cast<Player::PlayStyle>(style)) + "\"");
+    }
+    this->tail = ",\"numberOfPlayers\":" + std::to_string(roster.size()) +
+                 ",\"initialChipsPerPlayer\":" + std::to_string(roster.startingChips(0)) + ",\"allPlayerStrategies\":[";
+    this->out.append("[");
+}
+
+// Rows are formatted into reserved AsyncWriter space, so the longest must fit its buffer.
+// Tables over GameRecord::MaxSeats seats are rejected before any per-game output is opened.
+static_assert(192 + 256 + static_cast<size_t>(GameRecord::MaxSeats) * 28 <= AsyncWriter::BufferBytes,
+              "A JSON row of the largest table must fit the writer's buffer");
+static_assert(2 + static_cast<size_t>(GameRecord::MaxSeats) * 21 <= AsyncWriter::BufferBytes,
+              "A chip history row of the largest table must fit the writer's buffer");
+
+inline void JsonRecordWriter::write(int worker, const GameRecord* records, size_t count) {
+    for (size_t k = 0; k < count; ++k) {
+        const GameRecord& record = records[k];
+        const std::vector<Player::PlayStyle>& seats = this->batches.strategies(record.batchId);
+        char* at = this->out.reserve(192 + this->tail.size() + seats.size() * 28);
+        at = AsyncWriter::put(at, this->first ? "\n{\"winnerStrategy\":" : ",\n{\"winnerStrategy\":");
+        at = AsyncWriter::put(at, this->strategies[std::min<int>(record.winnerStrategy, Player::PlayStyle::Random)]);
+        at = AsyncWriter::put(at, record.draw ? ",\"draw\":true,\"gameId\":" : ",\"draw\":false,\"gameId\":");
+        at = AsyncWriter::put(at, record.gameId);
+        at = AsyncWriter::put(at, ",\"batchId\":");
+        at = AsyncWriter::put(at, record.batchId);
+        at = AsyncWriter::put(at, ",\"winnerSeat\":");
+        at = AsyncWriter::put(at, record.winnerSeat);
+        at = AsyncWriter::put(at, ",\"numberOfRounds\":");
+        at = AsyncWriter::put(at, record.rounds);
+        at = AsyncWriter::put(at, this->tail);
+        for (size_t seat = 0; seat < seats.size(); ++seat) {
+            if (seat > 0) *at++ = ',';
+            at = AsyncWriter::put(at, this->strategies[std::min<int>(seats[seat], Player::PlayStyle::Random)]);
+        }
+        at = AsyncWriter::put(at, "]");
+        this->out.commit(at);
+        this->first = false;
+
+        if (this->histories && this->histories->sampler().selects(record)) {
+            const std::vector<std::vector<int>> snapshots = this->histories->take(worker, record.gameId);
+            this->out.append(",\"chipHistory\":[");
+            for (size_t turn = 0; turn < snapshots.size(); ++turn) {
+                char* row = this->out.reserve(2 + snapshots[turn].size() * 21);
+                if (turn > 0) *row++ = ',';
+                *row++ = '[';
+                for (size_t seat = 0; seat < snapshots[turn].size(); ++seat) {
+                    if (seat > 0) *row++ = ',';
+                    row = AsyncWriter::put(row, snapshots[turn][seat]);
+                }
+                *row++ = ']';
+                this->out.commit(row);
+            }
+            this->out.append("]");
+        }
+        this->out.append("}");
+    }
+}
+
+inline void JsonRecordWriter::finish() {
+    this->out.append("\n]\n");
+    this->out.finish();
+}
+
 NLOHMANN_JSON_SERIALIZE_ENUM( Output::OutputType, {
     {Output::OutputType::All, "all"},
-    {Output::OutputType::Totals, "totals"}
+    {Output::OutputType::Totals, "totals"},
+    {Output::OutputType::Binary, "binary"}
 })
 
 #endif //LCR_OUTPUT_H
@@ -0,0 +1,144 @@
+// =========================================================================
+// precision.h
+// =========================================================================
+#ifndef LCR_PRECISION_H
+#define LCR_PRECISION_H
+
+#include <cmath>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "player.h"
+#include "tally.h"
+#include "gameState.h"
+
+// Confidence intervals for the win rates a run tracks: every strategy that can be dealt and
+// every seat, each as a share of all games played. A win is a 0/1 outcome, so the running
+// mean and variance Welford's method would keep are the win and game counts of the Tally,
+// and its per-worker slots merge exactly. Intervals are Wilson score intervals, which stay
+// sensible for rates near 0 or 1 where the normal approximation collapses to zero width.
+//
+// Games are treated as independent. Replays of a batch share its deal, so with Random seats
+// the strategy intervals are somewhat narrower than a batch-level analysis would give.
+class Precision {
+public:
+    // Stop once every tracked interval is at most `halfWidth` wide on either side
+    struct Target {
+        double halfWidth = 0.0;
+        double confidence = 0.95;
+    };
+
+    struct Interval {
+        std::string label;
+        double estimate = 0.0;
+        double low = 0.0;
+        double high = 1.0;
+
+        double halfWidth() const { return (this->high - this->low) / 2.0; }
+    };
+
+    Precision(const Roster& roster, const Target& target);
+
+    const Target& target() const { return this->goal; }
+
+    // Two-sided normal quantile for `confidence` (0.95 -> 1.96)
+    static double zScore(double confidence);
+
+    static Interval wilson(uint64_t wins, uint64_t games, double z);
+
+    // Strategy intervals, then one per seat
+    std::vector<Interval> intervals(const Tally::Totals& totals) const;
+
+    // Widest half-width over the tracked rates; 1 before any game has finished
+    double widest(const Tally::Totals& totals) const;
+
+    bool met(const Tally::Totals& totals) const { return widest(totals) <= this->goal.halfWidth; }
+
+    // A run tests the target only once its first FirstCheck games have finished, then again
+    // each time an eighth more have, so it stops within an eighth of the games the target needs.
+    // The checks depend only on the number of games, never on threads or timing, so a seeded
+    // run with a target always plays the same games. Returns the check after `checked` games,
+    // capped at the run's `games`.
+    static constexpr int64_t FirstCheck = 16384;
+    static int64_t nextCheck(int64_t checked, int64_t games);
+
+private:
+    Target goal;
+    double z;
+    std::vector<Player::PlayStyle> strategies; // Those that can be dealt
+    std::vector<std::string> seatNames;
+};
+
+inline Precision::Precision(const Roster& roster, const Target& target) : goal(target), z(zScore(target.confidence)) {
+    if (!(target.halfWidth > 0.0 && target.halfWidth < 1.0)) {
+        throw std::invalid_argument("precision halfWidth must be between 0 and 1");
+    }
+    bool dealt[Tally::NumStrategies] = {};
+    for (int seat = 0; seat < roster.size(); ++seat) {
+        const Player::PlayStyle strategy = roster.strategy(seat);
+        if (strategy == Player::PlayStyle::Random) {
+            std::fill(std::begin(dealt), std::end(dealt), true);
+        } else {
+            dealt[strategy] = true;
+        }
+        this->seatNames.push_back(roster.name(seat));
+    }
+    for (int strategy = 0; strategy < Tally::NumStrategies; ++strategy) {
+        if (dealt[strategy]) this->strategies.push_back(static_cast<Player::PlayStyle>(strategy));
+    }
+}
+
+inline int64_t Precision::nextCheck(int64_t checked, int64_t games) {
+    return std::min(checked < FirstCheck ? FirstCheck : checked + checked / 8, games);
+}
+
+inline double Precision::zScore(double confidence) {
+    if (!(confidence > 0.0 && confidence < 1.0)) {
+        throw std::invalid_argument("precision confidence must be between 0 and 1");
+    }
+    // Solve erfc(z / sqrt(2)) = 1 - confidence by bisection; erfc is decreasing
+    const double tail = 1.0 - confidence;
+    double lo = 0.0, hi = 40.0;
+    for (int step = 0; step < 200; ++step) {
+        const double mid = (lo + hi) / 2.0;
+        if (std::erfc(mid / std::sqrt(2.0)) > tail) lo = mid; else hi = mid;
+    }
+    return (lo + hi) / 2.0;
+}
+
+inline Precision::Interval Precision::wilson(uint64_t wins, uint64_t games, double z) {
+    Interval interval;
+    if (games == 0) return interval;
+    const double n = static_cast<double>(games);
+    const double p = static_cast<double>(wins) / n;
+    const double z2 = z * z;
+    const double centre = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+    const double spread = z * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / (1.0 + z2 / n);
+    interval.estimate = p;
+    interval.low = std::max(0.0, centre - spread);
+    interval.high = std::min(1.0, centre + spread);
+    return interval;
+}
+
+inline std::vector<Precision::Interval> Precision::intervals(const Tally::Totals& totals) const {
+    std::vector<Interval> result;
+    for (Player::PlayStyle strategy : this->strategies) {
+        result.push_back(wilson(totals.strategyWins[strategy], totals.games, this->z));
+        result.back().label = Player::playStyleToString(strategy);
+    }
+    for (size_t seat = 0; seat < this->seatNames.size(); ++seat) {
+        result.push_back(wilson(totals.seatWins[seat], totals.games, this->z));
+        result.back().label = this->seatNames[seat];
+    }
+    return result;
+}
+
+inline double Precision::widest(const Tally::Totals& totals) const {
+    double widest = 0.0;
+    for (const Interval& interval : intervals(totals)) { widest = std::max(widest, interval.halfWidth()); }
+    return totals.games == 0 ? 1.0 : widest;
+}
+
+#endif //LCR_PRECISION_H
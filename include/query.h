@@ -0,0 +1,191 @@
+// =========================================================================
+// query.h
+// =========================================================================
+#ifndef LCR_QUERY_H
+#define LCR_QUERY_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "player.h"
+#include "threadPool.h"
+#include "resultStore.h"
+
+// Filtered group-by counts over a ResultStore. Blocks are scanned in parallel, one column at a
+// time with branch-free predicates the compiler can vectorise, into per-worker counters that
+// are merged at the end.
+//
+// Seat and strategy are the winner's, with -1 standing for a draw in both.
+class ResultQuery {
+public:
+    enum class GroupBy {
+        None,
+        Seat,     // Winning seat, -1 for draws
+        Strategy, // Winning strategy, -1 for draws
+        Rounds,   // Game length in rounds
+        Draw,     // 0 for a win, 1 for a draw
+    };
+
+    // Inclusive range a column must fall in
+    struct Range {
+        int64_t lo = std::numeric_limits<int64_t>::min();
+        int64_t hi = std::numeric_limits<int64_t>::max();
+
+        static Range only(int64_t value) { return Range{value, value}; }
+    };
+
+    // A game matches when every column is within its range
+    struct Filter {
+        Range seat;
+        Range strategy;
+        Range rounds;
+        Range draw;
+    };
+
+    struct Row {
+        int64_t key = 0;
+        uint64_t games = 0;
+        uint64_t rounds = 0; // Summed, for the mean game length
+
+        double meanRounds() const { return this->games ? static_cast<double>(this->rounds) / this->games : 0.0; }
+    };
+
+    // "none", "seat", "strategy", "rounds" or "draw"; throws std::invalid_argument otherwise
+    static GroupBy stringToGroupBy(const std::string& str);
+
+    // Rows with at least one matching game, in key order
+    static std::vector<Row> run(const ResultStore& store, const Filter& filter, GroupBy groupBy, ThreadPool& pool);
+
+private:
+    // Counters indexed by key - KeyBase<By>
+    struct Counts {
+        std::vector<uint64_t> games;
+        std::vector<uint64_t> rounds;
+    };
+
+    // Throws std::runtime_error if a grouped column holds a value no valid file can
+    template <GroupBy By>
+    static void scanBlock(const BlockColumns& block, const Filter& filter, Counts& counts);
+
+    static const char* columnName(GroupBy groupBy);
+};
+
+inline ResultQuery::GroupBy ResultQuery::stringToGroupBy(const std::string& str) {
+    if (str == "none") return GroupBy::None;
+    if (str == "seat") return GroupBy::Seat;
+    if (str == "strategy") return GroupBy::Strategy;
+    if (str == "rounds") return GroupBy::Rounds;
+    if (str == "draw") return GroupBy::Draw;
+    throw std::invalid_argument("Unknown group-by column: " + str);
+}
+
+inline const char* ResultQuery::columnName(GroupBy groupBy) {
+    switch (groupBy) {
+        case GroupBy::Seat: return "winner seat";
+        case GroupBy::Strategy: return "winner strategy";
+        case GroupBy::Rounds: return "rounds";
+        case GroupBy::Draw: return "draw flag";
+        default: return "column";
+    }
+}
+
+template <ResultQuery::GroupBy By>
+void ResultQuery::scanBlock(const BlockColumns& block, const Filter& filter, Counts& counts) {
+    const size_t n = block.count;
+    const int32_t* rounds = block.rounds;
+    const int16_t* seats = block.winnerSeat;
+    const uint8_t* strategies = block.winnerStrategy;
+    const uint8_t* draws = block.draw;
+
+    // Keys are offset by one so a draw's -1 lands in slot 0
+    size_t slots = 1;
+    if (By == GroupBy::Rounds) {
+        int32_t longest = 0;
+        for (size_t k = 0; k < n; ++k) { longest = std::max(longest, rounds[k]); }
+        slots = static_cast<size_t>(longest) + 1;
+    } else if (By == GroupBy::Seat) {
+        int16_t highest = -1;
+        for (size_t k = 0; k < n; ++k) { highest = std::max(highest, seats[k]); }
+        slots = static_cast<size_t>(highest) + 2;
+    } else if (By == GroupBy::Strategy) {
+        slots = Player::PlayStyle::Random + 1;
+    } else if (By == GroupBy::Draw) {
+        slots = 2;
+    }
+    if (counts.games.size() < slots) {
+        counts.games.resize(slots, 0);
+        counts.rounds.resize(slots, 0);
+    }
+    uint64_t* games = counts.games.data();
+    uint64_t* roundSums = counts.rounds.data();
+
+    bool outOfRange = false;
+    for (size_t k = 0; k < n; ++k) {
+        const int64_t seat = seats[k];
+        const int64_t strategy = draws[k] ? -1 : static_cast<int64_t>(strategies[k]);
+        const uint64_t keep = (seat >= filter.seat.lo) & (seat <= filter.seat.hi) &
+                              (strategy >= filter.strategy.lo) & (strategy <= filter.strategy.hi) &
+                              (rounds[k] >= filter.rounds.lo) & (rounds[k] <= filter.rounds.hi) &
+                              (draws[k] >= filter.draw.lo) & (draws[k] <= filter.draw.hi);
+        size_t key = 0;
+        if (By == GroupBy::Seat) key = static_cast<size_t>(seat + 1);
+        if (By == GroupBy::Strategy) key = static_cast<size_t>(strategy + 1);
+        if (By == GroupBy::Rounds) key = static_cast<size_t>(rounds[k]);
+        if (By == GroupBy::Draw) key = draws[k];
+        // A key past the counters (a negative value, an unknown strategy, a draw flag above 1)
+        // can only come from a corrupt file; count it nowhere and fail the block below
+        const bool inRange = key < slots;
+        outOfRange |= !inRange;
+        key = inRange ? key : 0;
+        games[key] += keep & inRange;
+        roundSums[key] += (keep & inRange) * static_cast<uint64_t>(rounds[k]);
+    }
+    if (outOfRange) {
+        throw std::runtime_error(std::string("Corrupt results block: ") + columnName(By) + " out of range.");
+    }
+}
+
+inline std::vector<ResultQuery::Row> ResultQuery::run(const ResultStore& store, const Filter& filter, GroupBy groupBy, ThreadPool& pool) {
+    const int numWorkers = pool.getThreadCount();
+    std::vector<Counts> perWorker(numWorkers);
+    std::vector<BlockBuffer> buffers(numWorkers);
+
+    pool.parallelFor(0, static_cast<int64_t>(store.numBlocks()), 1, [&](int64_t first, int64_t last) {
+        const int worker = ThreadPool::currentWorker();
+        for (int64_t index = first; index < last; ++index) {
+            const BlockColumns block = store.block(static_cast<size_t>(index), buffers[worker]);
+            switch (groupBy) {
+                case GroupBy::None: scanBlock<GroupBy::None>(block, filter, perWorker[worker]); break;
+                case GroupBy::Seat: scanBlock<GroupBy::Seat>(block, filter, perWorker[worker]); break;
+                case GroupBy::Strategy: scanBlock<GroupBy::Strategy>(block, filter, perWorker[worker]); break;
+                case GroupBy::Rounds: scanBlock<GroupBy::Rounds>(block, filter, perWorker[worker]); break;
+                case GroupBy::Draw: scanBlock<GroupBy::Draw>(block, filter, perWorker[worker]); break;
+            }
+        }
+    });
+
+    Counts total;
+    for (const Counts& counts : perWorker) {
+        if (total.games.size() < counts.games.size()) {
+            total.games.resize(counts.games.size(), 0);
+            total.rounds.resize(counts.rounds.size(), 0);
+        }
+        for (size_t slot = 0; slot < counts.games.size(); ++slot) {
+            total.games[slot] += counts.games[slot];
+            total.rounds[slot] += counts.rounds[slot];
+        }
+    }
+
+    const bool offset = groupBy == GroupBy::Seat || groupBy == GroupBy::Strategy;
+    std::vector<Row> rows;
+    for (size_t slot = 0; slot < total.games.size(); ++slot) {
+        if (total.games[slot] == 0) continue;
+        rows.push_back(Row{static_cast<int64_t>(slot) - (offset ? 1 : 0), total.games[slot], total.rounds[slot]});
+    }
+    return rows;
+}
+
+#endif //LCR_QUERY_H
@@ -12,23 +12,25 @@
 
 class Result {
 public:
+    static constexpr int NoWinner = -1;
+
     int gameId;
-    std::string winnerName;
+    int winnerSeat; // Seat index into the run's Roster, NoWinner for a draw
     Player::PlayStyle winnerStrategy;
     int numberOfRounds;
     int numberOfPlayers;
     int initialChipsPerPlayer;
-    std::vector<Player::PlayStyle> allPlayerStrategies;
+    const std::vector<Player::PlayStyle>* allPlayerStrategies; // The batch's assignment, shared by its replays
     bool draw;
-//    std::vector<std::vector<int>> chipHistory;
+    // Chip histories are recorded for sampled games only, see chipHistory.h
 
     // Default constructor
-    Result() : gameId(-1), winnerName(""), winnerStrategy(Player::PlayStyle::StealFromHighest), // Default placeholder
-               numberOfRounds(0), numberOfPlayers(0), initialChipsPerPlayer(0), draw(false) {}
+    Result() : gameId(-1), winnerSeat(NoWinner), winnerStrategy(Player::PlayStyle::StealFromHighest), // Default placeholder
+               numberOfRounds(0), numberOfPlayers(0), initialChipsPerPlayer(0), allPlayerStrategies(nullptr), draw(false) {}
 
     // Parameterized constructor
-    Result(int id, const std::string& wName, Player::PlayStyle wStrat, int rounds, int numP, int initChips, const std::vector<Player::PlayStyle>& allStrats, bool isDraw = false)
-            : gameId(id), winnerName(wName), winnerStrategy(wStrat), numberOfRounds(rounds),
+    Result(int id, int wSeat, Player::PlayStyle wStrat, int rounds, int numP, int initChips, const std::vector<Player::PlayStyle>* allStrats, bool isDraw = false)
+            : gameId(id), winnerSeat(wSeat), winnerStrategy(wStrat), numberOfRounds(rounds),
               numberOfPlayers(numP), initialChipsPerPlayer(initChips), allPlayerStrategies(allStrats), draw(isDraw) {}
 };
 
@@ -37,12 +39,11 @@ void to_json(nlohmann::json& j, const Result& result) {
             {"winnerStrategy", Player::playStyleToString(result.winnerStrategy)},
             {"draw", result.draw},
             {"gameId", result.gameId},
-            {"winnerName", result.winnerName},
+            {"winnerSeat", result.winnerSeat},
             {"numberOfRounds", result.numberOfRounds},
             {"numberOfPlayers", result.numberOfPlayers},
             {"initialChipsPerPlayer", result.initialChipsPerPlayer},
-            {"allPlayerStrategies", result.allPlayerStrategies},
-//            {"chipHistory", result.chipHistory}
+            {"allPlayerStrategies", result.allPlayerStrategies ? *result.allPlayerStrategies : std::vector<Player::PlayStyle>{}},
     };
 }
 
@@ -50,5 +51,5 @@ void to_json(nlohmann::json& j, const Result& result) {
 // Define how to convert Result class to/from JSON
 // Using NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE for simplicity if all members are public
 // If members were private, you'd write custom to_json/from_json functions
-//NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Result, gameId, winnerName, winnerStrategy, numberOfRounds, numberOfPlayers, initialChipsPerPlayer, allPlayerStrategies, draw);
+//NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Result, gameId, winnerSeat, winnerStrategy, numberOfRounds, numberOfPlayers, initialChipsPerPlayer, allPlayerStrategies, draw);
 #endif // LCR_RESULT_H
@@ -0,0 +1,188 @@
+// =========================================================================
+// resultSink.h
+// =========================================================================
+#ifndef LCR_RESULTSINK_H
+#define LCR_RESULTSINK_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <condition_variable>
+#include "result.h"
+
+// What the output stage keeps of a finished game: a 16-byte POD with no pointers. The roster
+// and table size are the same for the whole run, and the seat strategies the same for a
+// batch, so they live once in the Roster and BatchTable and are looked up by seat and batch.
+struct GameRecord {
+    static constexpr int MaxSeats = INT16_MAX; // Largest table whose winning seat fits winnerSeat
+
+    int32_t gameId;
+    int32_t batchId;        // Index into the run's BatchTable
+    int32_t rounds;
+    int16_t winnerSeat;     // Result::NoWinner for a draw
+    uint8_t winnerStrategy;
+    uint8_t draw;
+
+    static GameRecord from(const Result& result, int batchId) {
+        return GameRecord{result.gameId, batchId, result.numberOfRounds, static_cast<int16_t>(result.winnerSeat),
+                          static_cast<uint8_t>(result.winnerStrategy), static_cast<uint8_t>(result.draw)};
+    }
+};
+static_assert(sizeof(GameRecord) == 16, "GameRecord is kept to 16 bytes");
+
+// The record's own fields; the batch's strategies are in its BatchTable
+inline void to_json(nlohmann::json& j, const GameRecord& record) {
+    j = nlohmann::json{
+            {"gameId", record.gameId},
+            {"batchId", record.batchId},
+            {"winnerSeat", record.winnerSeat},
+            {"winnerStrategy", Player::playStyleToString(static_cast<Player::PlayStyle>(record.winnerStrategy))},
+            {"numberOfRounds", record.rounds},
+            {"draw", static_cast<bool>(record.draw)}
+    };
+}
+
+// Output stage fed by ResultSink's writer thread
+class RecordWriter {
+public:
+    virtual ~RecordWriter() = default;
+
+    // Called from the writer thread only, with records in no particular order across workers
+    // but in the order `worker` pushed them. Must not throw; report failures from finish() instead.
+    virtual void write(int worker, const GameRecord* records, size_t count) = 0;
+
+    // Called once after the last write
+    virtual void finish() {}
+};
+
+// Hands every record to several writers in turn, e.g. the CSV and the JSON results
+class RecordWriterGroup : public RecordWriter {
+public:
+    void add(std::unique_ptr<RecordWriter> writer) { this->writers.push_back(std::move(writer)); }
+    bool empty() const { return this->writers.empty(); }
+
+    void write(int worker, const GameRecord* records, size_t count) override {
+        for (const auto& writer : this->writers) { writer->write(worker, records, count); }
+    }
+    void finish() override {
+        for (const auto& writer : this->writers) { writer->finish(); }
+    }
+
+private:
+    std::vector<std::unique_ptr<RecordWriter>> writers;
+};
+
+// Streams finished games from the workers to a RecordWriter with bounded memory.
+// Every worker pushes into its own single-producer ring; one writer thread drains the rings
+// and hands the records over in contiguous runs. A worker whose ring is full waits for the
+// writer, so memory stays at numWorkers * ringCapacity records however long the run is.
+class ResultSink {
+public:
+    // ringCapacity is rounded up to a power of two
+    ResultSink(int numWorkers, RecordWriter& writer, size_t ringCapacity = 4096);
+    ~ResultSink();
+
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    // Queues a record from `worker`'s ring (0 <= worker < numWorkers)
+    void push(int worker, const GameRecord& record);
+
+    // Drains every ring, stops the writer thread and finishes the writer. Call once the
+    // workers are done pushing; also called by the destructor.
+    void close();
+
+private:
+    struct Ring {
+        alignas(64) std::atomic<size_t> tail{0}; // Next slot the worker fills
+        alignas(64) std::atomic<size_t> head{0}; // Next slot the writer drains
+        std::unique_ptr<GameRecord[]> slots;
+    };
+
+    // Hands everything currently queued to the writer; returns the number of records
+    size_t drain();
+    void run();
+
+    RecordWriter& writer;
+    size_t capacity;
+    std::vector<std::unique_ptr<Ring>> rings;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::atomic<bool> closing{false};
+    bool closed = false;
+    std::thread writerThread;
+};
+
+inline ResultSink::ResultSink(int numWorkers, RecordWriter& writer, size_t ringCapacity) : writer(writer), capacity(2) {
+    while (this->capacity < ringCapacity) { this->capacity <<= 1; }
+    for (int worker = 0; worker < numWorkers; ++worker) {
+        this->rings.push_back(std::make_unique<Ring>());
+        this->rings.back()->slots.reset(new GameRecord[this->capacity]);
+    }
+    this->writerThread = std::thread([this] { run(); });
+}
+
+inline ResultSink::~ResultSink() {
+    close();
+}
+
+inline void ResultSink::push(int worker, const GameRecord& record) {
+    Ring& ring = *this->rings[worker];
+    size_t tail = ring.tail.load(std::memory_order_relaxed);
+    while (tail - ring.head.load(std::memory_order_acquire) == this->capacity) {
+        this->wake.notify_one();
+        std::this_thread::yield(); // Full: wait for the writer to catch up
+    }
+
+    ring.slots[tail & (this->capacity - 1)] = record;
+    ring.tail.store(tail + 1, std::memory_order_release);
+
+    // Wake the writer early once a ring is half full rather than waiting for its next poll
+    if (((tail + 1) & (this->capacity / 2 - 1)) == 0) { this->wake.notify_one(); }
+}
+
+inline size_t ResultSink::drain() {
+    size_t drained = 0;
+    for (int worker = 0; worker < static_cast<int>(this->rings.size()); ++worker) {
+        Ring& ring = *this->rings[worker];
+        size_t head = ring.head.load(std::memory_order_relaxed);
+        size_t tail = ring.tail.load(std::memory_order_acquire);
+        while (head != tail) {
+            // Up to the end of the buffer, then the wrapped part on the next pass
+            size_t offset = head & (this->capacity - 1);
+            size_t count = std::min(tail - head, this->capacity - offset);
+            this->writer.write(worker, &ring.slots[offset], count);
+            head += count;
+            drained += count;
+            ring.head.store(head, std::memory_order_release);
+        }
+    }
+    return drained;
+}
+
+inline void ResultSink::run() {
+    while (!this->closing.load(std::memory_order_acquire)) {
+        if (drain() == 0) {
+            std::unique_lock<std::mutex> lock(this->wake_mutex);
+            this->wake.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+    drain(); // Whatever was pushed before close()
+}
+
+inline void ResultSink::close() {
+    if (this->closed) return;
+    this->closed = true;
+    this->closing.store(true, std::memory_order_release);
+    this->wake.notify_one();
+    if (this->writerThread.joinable()) { this->writerThread.join(); }
+    this->writer.finish();
+}
+
+#endif //LCR_RESULTSINK_H
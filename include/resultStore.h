@@ -0,0 +1,112 @@
+// =========================================================================
+// resultStore.h
+// =========================================================================
+#ifndef LCR_RESULTSTORE_H
+#define LCR_RESULTSTORE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "json.hpp"
+#include "binaryOutput.h"
+
+// Read-only memory map of a binary results file (.lcrb). Opening it only walks the block
+// headers; the columns are paged in by the OS as queries touch them, so a file larger than
+// RAM can be scanned. Plain-encoded columns are read in place, varint ones decoded per block.
+class ResultStore {
+public:
+    // Maps and indexes `path`; throws std::runtime_error on a missing or corrupt file
+    explicit ResultStore(const std::string& path);
+    ~ResultStore();
+
+    ResultStore(const ResultStore&) = delete;
+    ResultStore& operator=(const ResultStore&) = delete;
+
+    const nlohmann::json& header() const { return this->headerData; }
+    size_t numBlocks() const { return this->blocks.size(); }
+    uint64_t numGames() const { return this->games; }
+
+    // Columns of block `index`; `buffer` holds them if they had to be decoded. Safe to call
+    // from several threads with a buffer each.
+    BlockColumns block(size_t index, BlockBuffer& buffer) const {
+        const Block& block = this->blocks[index];
+        return BlockBuffer::decode(this->data + block.offset, block.size, block.count, this->compressed, buffer);
+    }
+
+private:
+    struct Block {
+        size_t offset; // Of the payload
+        uint32_t count;
+        uint32_t size;
+    };
+
+    int fd = -1;
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    nlohmann::json headerData;
+    bool compressed = false;
+    uint64_t games = 0;
+    std::vector<Block> blocks;
+};
+
+inline ResultStore::ResultStore(const std::string& path) {
+    this->fd = ::open(path.c_str(), O_RDONLY);
+    if (this->fd < 0) {
+        throw std::runtime_error("Could not open results file: " + path);
+    }
+    struct stat info {};
+    if (::fstat(this->fd, &info) != 0 || info.st_size < static_cast<off_t>(BinaryFormat::PreambleBytes)) {
+        ::close(this->fd);
+        throw std::runtime_error("Not an LCR binary results file: " + path);
+    }
+    this->length = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, this->fd, 0);
+    if (mapping == MAP_FAILED) {
+        ::close(this->fd);
+        throw std::runtime_error("Could not map results file: " + path);
+    }
+    this->data = static_cast<const uint8_t*>(mapping);
+    ::madvise(mapping, this->length, MADV_SEQUENTIAL);
+
+    try {
+        auto readU32 = [&](size_t offset) {
+            uint32_t value;
+            std::memcpy(&value, this->data + offset, sizeof(value));
+            return value;
+        };
+        BinaryFormat::checkPreamble(reinterpret_cast<const char*>(this->data), readU32(sizeof(BinaryFormat::Magic)));
+        size_t headerLength = readU32(sizeof(BinaryFormat::Magic) + sizeof(uint32_t));
+        if (this->length - BinaryFormat::PreambleBytes < headerLength) {
+            throw std::runtime_error("Truncated results file header.");
+        }
+        const char* text = reinterpret_cast<const char*>(this->data + BinaryFormat::PreambleBytes);
+        this->headerData = nlohmann::json::parse(text, text + headerLength);
+        this->compressed = this->headerData.value("encoding", "plain") == "varint";
+
+        for (size_t offset = BinaryFormat::PreambleBytes + headerLength; offset < this->length;) {
+            if (this->length - offset < 2 * sizeof(uint32_t)) throw std::runtime_error("Truncated results block.");
+            Block block{offset + 2 * sizeof(uint32_t), readU32(offset), readU32(offset + sizeof(uint32_t))};
+            if (this->length - block.offset < block.size) throw std::runtime_error("Truncated results block.");
+            this->blocks.push_back(block);
+            this->games += block.count;
+            offset = block.offset + block.size;
+        }
+    } catch (...) {
+        ::munmap(mapping, this->length);
+        ::close(this->fd);
+        throw;
+    }
+}
+
+inline ResultStore::~ResultStore() {
+    ::munmap(const_cast<uint8_t*>(this->data), this->length);
+    ::close(this->fd);
+}
+
+#endif //LCR_RESULTSTORE_H
@@ -0,0 +1,90 @@
+// =========================================================================
+// rng.h
+// =========================================================================
+#ifndef LCR_RNG_H
+#define LCR_RNG_H
+
+#include <cstdint>
+#include <limits>
+
+// Counter-based random number generator.
+// Each value is the SplitMix64 finalizer applied to (key + counter * gamma), so a
+// stream is fully described by its key and position. Streams derived from the same
+// seed with different stream ids are independent, and jumping ahead is O(1).
+class Rng {
+public:
+    using result_type = uint64_t;
+
+    // Stream ids at or above this value are reserved for per-batch setup
+    // (random starter / random strategies); game streams use the game id.
+    static constexpr uint64_t BatchStreamBase = 1ULL << 63;
+
+    // Weyl increment between successive counter values
+    static constexpr uint64_t Gamma = 0x9E3779B97F4A7C15ULL;
+
+    Rng(uint64_t seed = 0, uint64_t stream = 0);
+
+    // Next 64 random bits
+    uint64_t next();
+
+    // Uniform integer in [0, bound)
+    uint32_t below(uint32_t bound);
+
+    // Stream positioning
+    void discard(uint64_t n) { this->counter += n; }
+    void seek(uint64_t position) { this->counter = position; }
+    uint64_t position() const { return this->counter; }
+    uint64_t streamKey() const { return this->key; } // For engines that step many streams together
+
+    // UniformRandomBitGenerator interface so <random> distributions still work
+    result_type operator()() { return next(); }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    static uint64_t mix(uint64_t z);
+
+    // mix() in place, on a word or on every element of a GCC/Clang vector of words, so an
+    // engine stepping many streams together produces the same words
+    template <typename Words>
+    static void mixWords(Words& z);
+
+    // Maps a random word onto [0, range) with one multiply-high; bias is at most range / 2^64
+    static uint32_t scale(uint64_t word, uint32_t range);
+
+private:
+    uint64_t key;
+    uint64_t counter;
+};
+
+inline uint64_t Rng::mix(uint64_t z) {
+    mixWords(z);
+    return z;
+}
+
+template <typename Words>
+inline void Rng::mixWords(Words& z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+}
+
+inline uint32_t Rng::scale(uint64_t word, uint32_t range) {
+    // High 64 bits of the 96-bit product word * range, without 128-bit arithmetic
+    uint64_t lo = (word & 0xFFFFFFFFULL) * range;
+    uint64_t hi = (word >> 32) * range;
+    return static_cast<uint32_t>((hi + (lo >> 32)) >> 32);
+}
+
+inline Rng::Rng(uint64_t seed, uint64_t stream)
+        : key(mix(mix(seed) ^ (stream * Gamma + 0x632BE59BD9B4E019ULL))), counter(0) {}
+
+inline uint64_t Rng::next() {
+    return mix(this->key + (++this->counter) * Gamma);
+}
+
+inline uint32_t Rng::below(uint32_t bound) {
+    // Multiply-shift on the top 32 bits; bias is at most bound / 2^32
+    return static_cast<uint32_t>(((next() >> 32) * bound) >> 32);
+}
+
+#endif //LCR_RNG_H
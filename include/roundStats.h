@@ -0,0 +1,111 @@
+// =========================================================================
+// roundStats.h
+// =========================================================================
+#ifndef LCR_ROUNDSTATS_H
+#define LCR_ROUNDSTATS_H
+
+#include <vector>
+#include <cassert>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+// Chips held per seat at the end of every round, summed over all the games of a run, for
+// the population heatmap. Games count towards every round they reached; in a game's last
+// round the chips are taken where the game ended. Rounds past MaxRounds share one overflow row.
+class RoundStats {
+public:
+    static constexpr int MaxRounds = 128;
+    static constexpr int Rows = MaxRounds + 1; // Row r - 1 for round r, then the overflow row
+
+    // One worker's counters, written by that worker only and merged once the run is over
+    class Accumulator {
+    public:
+        explicit Accumulator(int numSeats)
+                : numSeats(numSeats), games(Rows, 0), sums(static_cast<size_t>(Rows) * numSeats, 0),
+                  squares(static_cast<size_t>(Rows) * numSeats, 0) {}
+
+        // Adds a game's chips at the end of `round` (1-based); `numChips` is the length of the
+        // caller's array and must be the table's seat count
+        template <typename Chip>
+        void add(int round, const Chip* chips, int numChips) {
+            assert(numChips == this->numSeats);
+            const size_t row = static_cast<size_t>(std::min(round, Rows)) - 1;
+            uint64_t* sum = &this->sums[row * this->numSeats];
+            uint64_t* square = &this->squares[row * this->numSeats];
+            this->games[row]++;
+            // Never write past the row, even when a release build drops the assert
+            const int seats = std::min(numChips, this->numSeats);
+            for (int seat = 0; seat < seats; ++seat) {
+                const uint64_t held = static_cast<uint64_t>(chips[seat]);
+                sum[seat] += held;
+                square[seat] += held * held;
+            }
+        }
+
+    private:
+        friend class RoundStats;
+
+        int numSeats;
+        std::vector<uint64_t> games;   // Per row
+        std::vector<uint64_t> sums;    // Row-major, numSeats per row
+        std::vector<uint64_t> squares;
+    };
+
+    // The merged matrix
+    struct Totals {
+        std::vector<uint64_t> games;
+        std::vector<uint64_t> sums;
+        std::vector<uint64_t> squares;
+    };
+
+    RoundStats(int numWorkers, int numSeats) : numSeats(numSeats) {
+        for (int worker = 0; worker < numWorkers; ++worker) {
+            this->accumulators.push_back(std::make_unique<Accumulator>(numSeats));
+        }
+    }
+
+    int getNumSeats() const { return this->numSeats; }
+    Accumulator& worker(int worker) { return *this->accumulators[worker]; }
+
+    // Call once the workers have stopped
+    Totals merge() const;
+
+    // Adds an earlier matrix (a checkpoint's) to worker 0; call before the workers start
+    void restore(const Totals& totals);
+
+private:
+    int numSeats;
+    std::vector<std::unique_ptr<Accumulator>> accumulators;
+};
+
+inline RoundStats::Totals RoundStats::merge() const {
+    Totals totals;
+    totals.games.assign(Rows, 0);
+    totals.sums.assign(static_cast<size_t>(Rows) * this->numSeats, 0);
+    totals.squares.assign(static_cast<size_t>(Rows) * this->numSeats, 0);
+    for (const auto& accumulator : this->accumulators) {
+        for (size_t k = 0; k < totals.games.size(); ++k) { totals.games[k] += accumulator->games[k]; }
+        for (size_t k = 0; k < totals.sums.size(); ++k) {
+            totals.sums[k] += accumulator->sums[k];
+            totals.squares[k] += accumulator->squares[k];
+        }
+    }
+    return totals;
+}
+
+inline void RoundStats::restore(const Totals& totals) {
+    Accumulator& accumulator = *this->accumulators[0];
+    if (totals.games.size() != accumulator.games.size() || totals.sums.size() != accumulator.sums.size() ||
+        totals.squares.size() != accumulator.squares.size()) {
+        throw std::invalid_argument("Round statistics do not match the table size");
+    }
+    for (size_t k = 0; k < totals.games.size(); ++k) { accumulator.games[k] += totals.games[k]; }
+    for (size_t k = 0; k < totals.sums.size(); ++k) {
+        accumulator.sums[k] += totals.sums[k];
+        accumulator.squares[k] += totals.squares[k];
+    }
+}
+
+#endif //LCR_ROUNDSTATS_H
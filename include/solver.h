@@ -0,0 +1,328 @@
+// =========================================================================
+// solver.h
+// =========================================================================
+#ifndef LCR_SOLVER_H
+#define LCR_SOLVER_H
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+#include <unordered_map>
+#include "json.hpp"
+#include "config.h"
+#include "game.h"
+#include "dice.h"
+
+// Exact win probabilities for small tables.
+// A table's state is the chips in front of every seat plus whose turn it is (the pot never
+// comes back into play). Transitions are generated by replaying every roll outcome through
+// Game::takeTurn, so the model follows exactly the same rules and steal targets as the
+// simulator. The resulting absorbing Markov chain is solved with Gauss-Seidel sweeps.
+class Solver {
+public:
+    // Bump whenever the game rules or steal tie-breaking change, to invalidate cached tables
+    static constexpr int RulesVersion = 2;
+    static constexpr int NumStrategies = Player::PlayStyle::StealOppositeConditional + 1;
+
+    struct Solution {
+        std::vector<double> seatWins;       // Indexed by seat (Player::getIndex())
+        double strategyWins[NumStrategies] = {};
+        double draw = 0.0;
+        size_t states = 0;                  // Summed over every table that was solved
+        int tables = 0;
+        int cachedTables = 0;
+    };
+
+    explicit Solver(size_t maxStates = 2'000'000, std::string cacheDir = "lcr_solve_cache")
+            : maxStates(maxStates), cacheDir(std::move(cacheDir)) {}
+
+    // Averages over the random strategy assignments and random starting player the simulator
+    // would draw, weighting each equally. Throws std::runtime_error if a table is too large.
+    Solution solveConfig(const Config& config);
+
+    // Solves one table: the roster's chips with one concrete strategy per seat, `startSeat`
+    // rolling first. Returns win probabilities by seat.
+    std::vector<double> solveTable(const Roster& roster, const std::vector<Player::PlayStyle>& strategies, int startSeat,
+                                   size_t& states, bool& cached);
+
+private:
+    static constexpr int MaxAssignments = 4096;
+    static constexpr double Tolerance = 1e-13;
+    static constexpr int MaxSweeps = 100'000;
+
+    size_t maxStates;
+    std::string cacheDir;
+
+    static std::string tableKey(const Roster& roster, const std::vector<Player::PlayStyle>& strategies, int startSeat);
+    std::string cachePath(const std::string& key) const;
+    bool loadCached(const std::string& key, std::vector<double>& wins, size_t& states) const;
+    void storeCached(const std::string& key, const std::vector<double>& wins, size_t states) const;
+};
+
+inline Solver::Solution Solver::solveConfig(const Config& config) {
+    Roster roster(config.players);
+    int numPlayers = roster.size();
+    if (numPlayers < 2) throw std::runtime_error("Game requires at least 2 players.");
+
+    std::vector<int> randomSeats;
+    for (int seat = 0; seat < numPlayers; ++seat) {
+        if (roster.strategy(seat) == Player::PlayStyle::Random) { randomSeats.push_back(seat); }
+    }
+
+    std::vector<int> starters;
+    if (config.startingPlayer < 0) {
+        for (int seat = 0; seat < numPlayers; ++seat) { starters.push_back(seat); }
+    } else {
+        starters.push_back(config.startingPlayer - 1);
+    }
+
+    long long assignments = 1;
+    for (size_t k = 0; k < randomSeats.size() && assignments <= MaxAssignments; ++k) { assignments *= NumStrategies; }
+    if (assignments * static_cast<long long>(starters.size()) > MaxAssignments) {
+        throw std::runtime_error("Too many random strategy / starting player combinations to solve exactly ("
+                                 + std::to_string(randomSeats.size()) + " random seats).");
+    }
+
+    Solution solution;
+    solution.seatWins.assign(numPlayers, 0.0);
+    double weight = 1.0 / static_cast<double>(assignments * starters.size());
+
+    for (long long a = 0; a < assignments; ++a) {
+        std::vector<Player::PlayStyle> strategies = roster.getStrategies();
+        long long digits = a;
+        for (int seat : randomSeats) {
+            strategies[seat] = static_cast<Player::PlayStyle>(digits % NumStrategies);
+            digits /= NumStrategies;
+        }
+
+        for (int starter : starters) {
+            size_t states = 0;
+            bool cached = false;
+            std::vector<double> wins = solveTable(roster, strategies, starter, states, cached);
+
+            solution.states += states;
+            solution.tables++;
+            if (cached) { solution.cachedTables++; }
+
+            double total = 0.0;
+            for (int seat = 0; seat < numPlayers; ++seat) {
+                solution.seatWins[seat] += weight * wins[seat];
+                solution.strategyWins[strategies[seat]] += weight * wins[seat];
+                total += wins[seat];
+            }
+            solution.draw += weight * (1.0 - total);
+        }
+    }
+
+    return solution;
+}
+
+inline std::vector<double> Solver::solveTable(const Roster& roster, const std::vector<Player::PlayStyle>& strategies, int startSeat,
+                                              size_t& states, bool& cached) {
+    const std::string key = tableKey(roster, strategies, startSeat);
+    std::vector<double> wins;
+    if (loadCached(key, wins, states)) {
+        cached = true;
+        return wins;
+    }
+    cached = false;
+
+    const int n = roster.size();
+    int totalChips = 0;
+    for (int seat = 0; seat < n; ++seat) { totalChips += roster.startingChips(seat); }
+
+    // State key: turn + n * (mixed-radix chip vector)
+    const uint64_t radix = static_cast<uint64_t>(totalChips) + 1;
+    if (std::pow(static_cast<double>(radix), n) * n > 9.0e18) {
+        throw std::runtime_error("Table is too large to solve exactly.");
+    }
+
+    auto encode = [&](const std::vector<int>& chips, int turn) {
+        uint64_t code = 0;
+        for (int seat = n - 1; seat >= 0; --seat) { code = code * radix + static_cast<uint64_t>(chips[seat]); }
+        return static_cast<uint64_t>(turn) + static_cast<uint64_t>(n) * code;
+    };
+    auto decode = [&](uint64_t code, std::vector<int>& chips) {
+        int turn = static_cast<int>(code % n);
+        code /= n;
+        for (int seat = 0; seat < n; ++seat) { chips[seat] = static_cast<int>(code % radix); code /= radix; }
+        return turn;
+    };
+    // Turns of players without chips are skipped, so only seats holding chips get a state.
+    // Returns -1 when every chip is in the pot (a draw).
+    auto nextTurn = [&](const std::vector<int>& chips, int turn) {
+        for (int step = 1; step <= n; ++step) {
+            int seat = (turn + step) % n;
+            if (chips[seat] > 0) return seat;
+        }
+        return -1;
+    };
+
+    std::vector<std::pair<Dice::Roll, double>> outcomes[Dice::MaxDicePerTurn + 1];
+    for (int k = 1; k <= Dice::MaxDicePerTurn; ++k) {
+        double sequences = std::pow(6.0, k);
+        for (const auto& [packed, weight] : Dice::outcomeWeights(k)) {
+            outcomes[k].emplace_back(Dice::Roll{packed}, weight / sequences);
+        }
+    }
+
+    // --- Build the transition model breadth-first from the starting table ---
+    std::vector<uint64_t> codes;
+    std::unordered_map<uint64_t, uint32_t> index;
+    std::vector<size_t> rowStart{0};
+    std::vector<uint32_t> columns;
+    std::vector<double> probabilities;
+    std::vector<double> winProbability; // Chance the player on turn wins outright from this state
+
+    std::vector<int> chips(n);
+    for (int seat = 0; seat < n; ++seat) { chips[seat] = roster.startingChips(seat); }
+    int firstTurn = chips[startSeat] > 0 ? startSeat : nextTurn(chips, startSeat);
+    if (firstTurn < 0) {
+        states = 0;
+        return std::vector<double>(n, 0.0);
+    }
+    codes.push_back(encode(chips, firstTurn));
+    index.emplace(codes.back(), 0);
+
+    GameState state;
+    state.reset(roster, strategies, startSeat);
+    Game game(state);
+    std::vector<std::pair<uint32_t, double>> row;
+    for (size_t s = 0; s < codes.size(); ++s) {
+        int turn = decode(codes[s], chips);
+        int numOfRolls = std::min(chips[turn], Dice::MaxDicePerTurn);
+        double win = 0.0;
+        row.clear();
+
+        for (const auto& [roll, probability] : outcomes[numOfRolls]) {
+            for (int seat = 0; seat < n; ++seat) { state.setChips(seat, chips[seat]); }
+            if (game.takeTurn(turn, roll)) {
+                win += probability;
+                continue;
+            }
+
+            std::vector<int> after(n);
+            for (int seat = 0; seat < n; ++seat) { after[seat] = state.getChips(seat); }
+            int next = nextTurn(after, turn);
+            if (next < 0) continue; // Draw
+
+            uint64_t code = encode(after, next);
+            auto [it, inserted] = index.emplace(code, static_cast<uint32_t>(codes.size()));
+            if (inserted) {
+                codes.push_back(code);
+                if (codes.size() > maxStates) {
+                    throw std::runtime_error("Table exceeds " + std::to_string(maxStates) + " states; too large to solve exactly.");
+                }
+            }
+            auto existing = std::find_if(row.begin(), row.end(), [&](const auto& e) { return e.first == it->second; });
+            if (existing != row.end()) { existing->second += probability; }
+            else { row.emplace_back(it->second, probability); }
+        }
+
+        for (const auto& [column, probability] : row) {
+            columns.push_back(column);
+            probabilities.push_back(probability);
+        }
+        rowStart.push_back(columns.size());
+        winProbability.push_back(win);
+    }
+
+    // --- Gauss-Seidel: value[s][seat] = P(seat eventually wins | state s) ---
+    const size_t numStates = codes.size();
+    std::vector<int> turnOf(numStates);
+    for (size_t s = 0; s < numStates; ++s) { turnOf[s] = static_cast<int>(codes[s] % n); }
+
+    std::vector<double> value(numStates * n, 0.0);
+    std::vector<double> next(n);
+    double maxDelta = 0.0;
+    for (int sweep = 0; sweep < MaxSweeps; ++sweep) {
+        maxDelta = 0.0;
+        // Later-discovered states sit further into the game, so sweep them first
+        for (size_t s = numStates; s-- > 0;) {
+            std::fill(next.begin(), next.end(), 0.0);
+            next[turnOf[s]] = winProbability[s];
+            for (size_t e = rowStart[s]; e < rowStart[s + 1]; ++e) {
+                const double* target = &value[static_cast<size_t>(columns[e]) * n];
+                for (int seat = 0; seat < n; ++seat) { next[seat] += probabilities[e] * target[seat]; }
+            }
+            double* current = &value[s * n];
+            for (int seat = 0; seat < n; ++seat) {
+                maxDelta = std::max(maxDelta, std::abs(next[seat] - current[seat]));
+                current[seat] = next[seat];
+            }
+        }
+        if (maxDelta < Tolerance) break;
+    }
+    // Not cached: a table that did not converge must not be reported as exact
+    if (!(maxDelta < Tolerance)) {
+        std::ostringstream message;
+        message << "Solver did not converge within " << MaxSweeps << " sweeps (last change " << std::scientific
+                << std::setprecision(2) << maxDelta << ", tolerance " << Tolerance << ").";
+        throw std::runtime_error(message.str());
+    }
+
+    wins.assign(value.begin(), value.begin() + n);
+    states = numStates;
+    storeCached(key, wins, states);
+    return wins;
+}
+
+inline std::string Solver::tableKey(const Roster& roster, const std::vector<Player::PlayStyle>& strategies, int startSeat) {
+    std::ostringstream key;
+    key << "v" << RulesVersion << ";n=" << roster.size() << ";start=" << startSeat;
+    for (int seat = 0; seat < roster.size(); ++seat) {
+        key << ";" << roster.startingChips(seat) << ":" << static_cast<int>(strategies[seat]);
+    }
+    return key.str();
+}
+
+inline std::string Solver::cachePath(const std::string& key) const {
+    // FNV-1a over the key names the file; the key itself is stored inside to rule out collisions
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) { hash = (hash ^ c) * 0x100000001b3ULL; }
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hash << ".json";
+    return (std::filesystem::path(cacheDir) / name.str()).string();
+}
+
+inline bool Solver::loadCached(const std::string& key, std::vector<double>& wins, size_t& states) const {
+    if (cacheDir.empty()) return false;
+    std::ifstream in(cachePath(key));
+    if (!in.is_open()) return false;
+    try {
+        nlohmann::json data;
+        in >> data;
+        if (data.at("key").get<std::string>() != key) return false;
+        wins = data.at("wins").get<std::vector<double>>();
+        states = data.at("states").get<size_t>();
+        return true;
+    } catch (const std::exception&) {
+        return false; // Unreadable cache entries are simply recomputed
+    }
+}
+
+inline void Solver::storeCached(const std::string& key, const std::vector<double>& wins, size_t states) const {
+    if (cacheDir.empty()) return;
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir, ec);
+
+    // Write to a temporary file and rename so concurrent runs never see a partial entry
+    std::string path = cachePath(key);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        if (!out.is_open()) return;
+        nlohmann::json data = {{"key", key}, {"wins", wins}, {"states", states}};
+        out << std::setprecision(17) << data.dump();
+    }
+    std::filesystem::rename(tmpPath, path, ec);
+}
+
+#endif //LCR_SOLVER_H
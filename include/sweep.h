@@ -0,0 +1,166 @@
+// =========================================================================
+// sweep.h
+// =========================================================================
+#ifndef LCR_SWEEP_H
+#define LCR_SWEEP_H
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "player.h"
+#include "gameState.h"
+
+// A grid of table variations played in one run: every combination of table size, starting
+// chips, strategy assignment and starting player is a cell, and every cell plays the same
+// numSimulations * runEachSim games from the run's seed. The cells' games are cut into chunks
+// of about equal estimated cost and interleaved, so one pool works through all of them at once
+// and a cheap cell finishes early instead of queueing behind an expensive one.
+class Sweep {
+public:
+    // Values for each axis; an axis left empty keeps the base config's table
+    struct Grid {
+        std::vector<int> totalPlayers;
+        std::vector<int> chips;
+        std::vector<std::vector<Player::PlayStyle>> strategies; // Per seat, repeated around the table
+        std::vector<int> startingPlayers;                       // 1-based; negative for a random starter
+    };
+
+    struct Cell {
+        int totalPlayers = 0;
+        std::string chips;       // Labels as in the config, for the results table
+        std::string strategies;
+        int startingPlayer = -1;
+        std::vector<Player> players;
+    };
+
+    // Game ids [first, last) of one cell
+    struct Chunk {
+        int cell;
+        int64_t first;
+        int64_t last;
+    };
+
+    // Every combination, table size outermost and starting player innermost. Throws
+    // std::invalid_argument for a table that cannot be played.
+    static std::vector<Cell> expand(const Grid& grid, const std::vector<Player>& base, int baseStartingPlayer);
+
+    // Relative cost of one of the cell's games: turns grow with the chips on the table, and
+    // dealing a game and finding steal targets with the seats
+    static double gameCost(const Cell& cell);
+
+    // Cuts every cell's games into chunks of about equal cost (about numWorkers * 32 in all, fewer
+    // games each for large runs)
+    // and deals them out round-robin: chunk k of every cell comes before chunk k + 1 of any
+    // cell. Claimed in order, all cells progress together.
+    static std::vector<Chunk> schedule(const std::vector<Cell>& cells, int64_t gamesPerCell, int numWorkers);
+
+    // Strategies as written in the config (1-based, -1 for random), "/"-separated; a single
+    // value when every seat has the same one
+    static std::string strategyLabel(const std::vector<Player::PlayStyle>& strategies);
+};
+
+inline std::vector<Sweep::Cell> Sweep::expand(const Grid& grid, const std::vector<Player>& base, int baseStartingPlayer) {
+    // Missing axes take the base table's per-seat values, repeated around larger tables
+    std::vector<std::vector<int>> chipOptions(grid.chips.empty() ? 1 : 0);
+    std::vector<std::vector<Player::PlayStyle>> strategyOptions = grid.strategies;
+    if (strategyOptions.empty()) strategyOptions.emplace_back();
+    for (const Player& player : base) {
+        if (grid.chips.empty()) chipOptions[0].push_back(player.getChips());
+        if (grid.strategies.empty()) strategyOptions[0].push_back(player.getPlayStyle());
+    }
+    for (int chips : grid.chips) { chipOptions.push_back({chips}); }
+    const std::vector<int> sizes = grid.totalPlayers.empty() ? std::vector<int>{static_cast<int>(base.size())} : grid.totalPlayers;
+    const std::vector<int> starters = grid.startingPlayers.empty() ? std::vector<int>{baseStartingPlayer} : grid.startingPlayers;
+
+    std::vector<Cell> cells;
+    for (int size : sizes) {
+        if (size < 2) throw std::invalid_argument("sweep totalPlayers must be at least 2");
+        for (const std::vector<int>& chips : chipOptions) {
+            for (const std::vector<Player::PlayStyle>& strategies : strategyOptions) {
+                if (chips.empty() || strategies.empty()) throw std::invalid_argument("sweep chips and strategies must not be empty");
+                for (int starter : starters) {
+                    if (starter == 0 || starter > size) {
+                        throw std::invalid_argument("sweep startingPlayer " + std::to_string(starter) + " is not a seat of a " +
+                                                    std::to_string(size) + "-player table");
+                    }
+                    Cell cell;
+                    cell.totalPlayers = size;
+                    cell.startingPlayer = starter;
+                    cell.strategies = strategyLabel(strategies);
+                    cell.chips = std::to_string(chips[0]);
+                    if (!std::all_of(chips.begin(), chips.end(), [&](int c) { return c == chips[0]; })) {
+                        for (size_t k = 1; k < chips.size(); ++k) { cell.chips += "/" + std::to_string(chips[k]); }
+                    }
+                    int64_t totalChips = 0;
+                    for (int seat = 0; seat < size; ++seat) {
+                        const int seatChips = chips[seat % chips.size()];
+                        if (seatChips < 1 || seatChips > Roster::MaxChips) {
+                            throw std::invalid_argument("sweep chips must be between 1 and " + std::to_string(Roster::MaxChips));
+                        }
+                        totalChips += seatChips;
+                        const std::string name = seat < static_cast<int>(base.size()) ? base[seat].getName() : "Player " + std::to_string(seat + 1);
+                        cell.players.emplace_back(name, seatChips, seat, strategies[seat % strategies.size()], size);
+                    }
+                    if (totalChips > Roster::MaxChips) {
+                        throw std::invalid_argument("a " + std::to_string(size) + "-player sweep table with " + cell.chips + " chips holds " +
+                                                    std::to_string(totalChips) + " chips in all; at most " + std::to_string(Roster::MaxChips) + " fit");
+                    }
+                    cells.push_back(std::move(cell));
+                }
+            }
+        }
+    }
+    return cells;
+}
+
+inline double Sweep::gameCost(const Cell& cell) {
+    double chips = 0.0;
+    for (const Player& player : cell.players) { chips += player.getChips(); }
+    return chips + cell.totalPlayers;
+}
+
+inline std::vector<Sweep::Chunk> Sweep::schedule(const std::vector<Cell>& cells, int64_t gamesPerCell, int numWorkers) {
+    double totalCost = 0.0;
+    double cheapest = std::numeric_limits<double>::infinity();
+    for (const Cell& cell : cells) {
+        totalCost += gameCost(cell) * static_cast<double>(gamesPerCell);
+        cheapest = std::min(cheapest, gameCost(cell));
+    }
+    // At most 4096 of the cheapest cell's games, so costlier cells' chunks stay in proportion
+    const double chunkCost = std::min(totalCost / (static_cast<double>(std::max(numWorkers, 1)) * 32.0), cheapest * 4096.0);
+
+    std::vector<int64_t> chunkGames(cells.size());
+    for (size_t cell = 0; cell < cells.size(); ++cell) {
+        chunkGames[cell] = std::clamp<int64_t>(static_cast<int64_t>(chunkCost / gameCost(cells[cell])), 1, 4096);
+    }
+
+    std::vector<Chunk> chunks;
+    for (int64_t round = 0;; ++round) {
+        bool dealt = false;
+        for (size_t cell = 0; cell < cells.size(); ++cell) {
+            const int64_t first = round * chunkGames[cell];
+            if (first >= gamesPerCell) continue;
+            chunks.push_back({static_cast<int>(cell), first, std::min(first + chunkGames[cell], gamesPerCell)});
+            dealt = true;
+        }
+        if (!dealt) break;
+    }
+    return chunks;
+}
+
+inline std::string Sweep::strategyLabel(const std::vector<Player::PlayStyle>& strategies) {
+    auto code = [](Player::PlayStyle strategy) {
+        return strategy == Player::PlayStyle::Random ? std::string("-1") : std::to_string(static_cast<int>(strategy) + 1);
+    };
+    if (std::all_of(strategies.begin(), strategies.end(), [&](Player::PlayStyle s) { return s == strategies[0]; })) {
+        return code(strategies[0]);
+    }
+    std::string label;
+    for (size_t k = 0; k < strategies.size(); ++k) { label += (k > 0 ? "/" : "") + code(strategies[k]); }
+    return label;
+}
+
+#endif //LCR_SWEEP_H
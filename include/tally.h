@@ -0,0 +1,117 @@
+// =========================================================================
+// tally.h
+// =========================================================================
+#ifndef LCR_TALLY_H
+#define LCR_TALLY_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "player.h"
+#include "result.h"
+
+// Win counts for a run, kept per worker so finishing a game touches only the worker's own
+// cache lines. Each slot is written by its worker alone; the counters are atomics updated
+// with a plain load + store (no locked instructions) only so merge() can read running totals
+// from another thread while games are still being played.
+class Tally {
+public:
+    static constexpr int NumStrategies = Player::PlayStyle::StealOppositeConditional + 1;
+
+    // Summed over every worker
+    struct Totals {
+        uint64_t games = 0;
+        uint64_t draws = 0;
+        uint64_t strategyWins[NumStrategies] = {};
+        std::vector<uint64_t> seatWins;
+
+        uint64_t wins() const { return this->games - this->draws; }
+    };
+
+    Tally(int numWorkers, int numSeats);
+
+    // Counts a finished game for `worker` (0 <= worker < numWorkers)
+    void add(int worker, const Result& result);
+
+    // Running totals; exact once the workers have stopped
+    Totals merge() const;
+
+    // Adds earlier totals (a checkpoint's) to worker 0; call before the workers start
+    void restore(const Totals& totals);
+
+private:
+    using Counter = std::atomic<uint64_t>;
+    static constexpr int CountersPerLine = 64 / sizeof(Counter);
+
+    struct alignas(64) Line {
+        Counter counters[CountersPerLine] = {};
+    };
+
+    // A worker's slot is `lineStride` lines: games, draws and the strategy wins first, then
+    // the seat wins
+    static constexpr int SeatOffset = 2 + NumStrategies;
+
+    static void bump(Counter& counter, std::memory_order order = std::memory_order_relaxed) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, order);
+    }
+    Counter& counter(int worker, int index) {
+        return this->lines[static_cast<size_t>(worker) * this->lineStride + index / CountersPerLine].counters[index % CountersPerLine];
+    }
+    const Counter& counter(int worker, int index) const {
+        return this->lines[static_cast<size_t>(worker) * this->lineStride + index / CountersPerLine].counters[index % CountersPerLine];
+    }
+
+    int numWorkers;
+    int numSeats;
+    int lineStride;
+    std::unique_ptr<Line[]> lines;
+};
+
+inline Tally::Tally(int numWorkers, int numSeats)
+        : numWorkers(numWorkers), numSeats(numSeats),
+          lineStride((SeatOffset + numSeats + CountersPerLine - 1) / CountersPerLine),
+          lines(new Line[static_cast<size_t>(numWorkers) * lineStride]) {}
+
+inline void Tally::add(int worker, const Result& result) {
+    bump(counter(worker, 0));
+    if (result.draw) {
+        bump(counter(worker, 1), std::memory_order_release); // Publishes the game bumped above along with the draw
+        return;
+    }
+    bump(counter(worker, 2 + result.winnerStrategy));
+    bump(counter(worker, SeatOffset + result.winnerSeat));
+}
+
+inline Tally::Totals Tally::merge() const {
+    Totals totals;
+    totals.seatWins.assign(this->numSeats, 0);
+    for (int worker = 0; worker < this->numWorkers; ++worker) {
+        // Draws first, with acquire: every game counted before the draws read is then visible,
+        // so a running total never shows more draws than games
+        totals.draws += counter(worker, 1).load(std::memory_order_acquire);
+        totals.games += counter(worker, 0).load(std::memory_order_relaxed);
+        for (int strategy = 0; strategy < NumStrategies; ++strategy) {
+            totals.strategyWins[strategy] += counter(worker, 2 + strategy).load(std::memory_order_relaxed);
+        }
+        for (int seat = 0; seat < this->numSeats; ++seat) {
+            totals.seatWins[seat] += counter(worker, SeatOffset + seat).load(std::memory_order_relaxed);
+        }
+    }
+    return totals;
+}
+
+inline void Tally::restore(const Totals& totals) {
+    auto addTo = [this](int index, uint64_t count) {
+        Counter& slot = counter(0, index);
+        slot.store(slot.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    };
+    addTo(0, totals.games);
+    addTo(1, totals.draws);
+    for (int strategy = 0; strategy < NumStrategies; ++strategy) { addTo(2 + strategy, totals.strategyWins[strategy]); }
+    for (int seat = 0; seat < this->numSeats && seat < static_cast<int>(totals.seatWins.size()); ++seat) {
+        addTo(SeatOffset + seat, totals.seatWins[seat]);
+    }
+}
+
+#endif //LCR_TALLY_H
@@ -11,6 +11,9 @@
 #include <condition_variable>
 #include <queue>
 #include <functional>
+#include <algorithm>
+#include <exception>
+#include <cstdint>
 
 class ThreadPool {
 private:
@@ -57,6 +60,11 @@ private:
 
     std::vector<std::unique_ptr<ThreadInfo>> threadInfo;
 
+    static int& workerSlot() {
+        thread_local int index = -1;
+        return index;
+    }
+
 public:
     ThreadPool(size_t threads) {
         threadInfo.reserve(threads);
@@ -66,6 +74,7 @@ public:
             threadInfo.emplace_back(std::make_unique<ThreadInfo>(static_cast<int>(i)));
 
             workers.emplace_back([this, i] {
+                workerSlot() = static_cast<int>(i);
                 while(true) {
                     std::function<void()> task;
                     {
@@ -105,6 +114,67 @@ public:
         condition.notify_one();
     }
 
+    // Runs body(first, last) over [begin, end) in contiguous chunks of up to `grain` ids.
+    // One task per worker claims chunks from a shared atomic cursor, so there are no
+    // per-item queue operations. Blocks until every chunk has run; must not be called
+    // from a worker. If body throws, no further chunks are handed out and the first
+    // exception is rethrown here once the workers have stopped.
+    template<class F>
+    void parallelFor(int64_t begin, int64_t end, int64_t grain, F&& body) {
+        const std::atomic<bool> never{false};
+        parallelFor(begin, end, grain, std::forward<F>(body), never);
+    }
+
+    // As above, but once `cancel` is set no further chunks are handed out. Chunks already
+    // claimed run to completion, so the ids that ran are always [begin, ranUntil) for the
+    // returned ranUntil.
+    template<class F>
+    int64_t parallelFor(int64_t begin, int64_t end, int64_t grain, F&& body, const std::atomic<bool>& cancel) {
+        if (begin >= end) return begin;
+        grain = std::max<int64_t>(grain, 1);
+
+        std::atomic<int64_t> cursor{begin};
+        std::mutex done_mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+        int running = static_cast<int>(std::min<int64_t>(workers.size(), (end - begin + grain - 1) / grain));
+        int remaining = running;
+
+        for (int t = 0; t < running; ++t) {
+            enqueue([&] {
+                try {
+                    while (!cancel.load(std::memory_order_relaxed)) {
+                        const int64_t first = cursor.fetch_add(grain);
+                        if (first >= end) break;
+                        body(first, std::min(first + grain, end));
+                    }
+                } catch (...) {
+                    cursor.store(end);
+                    std::lock_guard<std::mutex> lock(done_mutex);
+                    if (!error) error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(done_mutex);
+                if (--remaining == 0) done.notify_one();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done.wait(lock, [&] { return remaining == 0; });
+        if (error) std::rethrow_exception(error);
+        return std::min(cursor.load(), end);
+    }
+
+    // Index of the calling pool thread in [0, getThreadCount()), or -1 on any other thread.
+    // Lets tasks keep per-worker state without locking.
+    static int currentWorker() {
+        return workerSlot();
+    }
+
+    int getThreadCount() const {
+        return static_cast<int>(workers.size());
+    }
+
     int getActiveTasks() const {
         return active_tasks;
     }
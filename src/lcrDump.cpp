@@ -0,0 +1,74 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include "../include/json.hpp"
+#include "../include/player.h"
+#include "../include/gameState.h"
+#include "../include/output.h"
+#include "../include/binaryOutput.h"
+
+using nlohmann::json;
+
+/**
+ * @brief Converts a binary results file back to the All CSV
+ *
+ * `lcr-dump <file.lcrb>` prints the CSV (with its header row) to stdout;
+ * `lcr-dump --header <file.lcrb>` prints the run description instead.
+ *
+ * @return int Exit status (0 for success, 1 on a bad file or usage)
+ */
+int main(int argc, char* argv[]) {
+    bool headerOnly = argc == 3 && std::string(argv[1]) == "--header";
+    if (argc != 2 && !headerOnly) {
+        std::cerr << "Usage: lcr-dump [--header] <results.lcrb>" << std::endl;
+        return 1;
+    }
+
+    const char* filename = argv[argc - 1];
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "File I/O Error: Could not open file for reading: " << filename << std::endl;
+        return 1;
+    }
+
+    try {
+        BinaryResultReader reader(in);
+        const json& header = reader.header();
+        if (headerOnly) {
+            std::cout << header.dump(4) << std::endl;
+            return 0;
+        }
+
+        // Rebuild the roster the run was played with; the CSV columns come from it
+        std::vector<Player> players;
+        const json& seats = header.at("players");
+        for (size_t seat = 0; seat < seats.size(); ++seat) {
+            players.emplace_back(seats[seat].at("name").get<std::string>(), seats[seat].at("chips").get<int>(),
+                                 static_cast<int>(seat), seats[seat].at("strategy").get<Player::PlayStyle>(),
+                                 static_cast<int>(seats.size()));
+        }
+        Roster roster(players);
+
+        std::ios::sync_with_stdio(false);
+        std::cout << CsvRecordWriter::Header << '\n';
+        CsvRecordWriter writer(std::cout, roster);
+        std::vector<GameRecord> records;
+        for (size_t block = 0; reader.nextBlock(records); ++block) {
+            // The writer names the winner by seat
+            for (const GameRecord& record : records) {
+                if (!record.draw && (record.winnerSeat < 0 || record.winnerSeat >= roster.size())) {
+                    throw std::runtime_error("Corrupt results block " + std::to_string(block) + ": game " +
+                                             std::to_string(record.gameId) + " has winner seat " +
+                                             std::to_string(record.winnerSeat) + " at a table of " +
+                                             std::to_string(roster.size()) + ".");
+                }
+            }
+            writer.write(0, records.data(), records.size());
+        }
+        writer.finish();
+    } catch (const std::exception& e) {
+        std::cerr << "Error reading " << filename << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -10,219 +10,1006 @@
 #include <condition_variable>
 #include <queue>
 #include <functional>
+#include <random>
+#include <csignal>
 #include "../include/threadPool.h"
 #include "../include/helpers.h"
+#include "../include/config.h"
+#include "../include/solver.h"
+#include "../include/kernel.h"
+#include "../include/lockstep.h"
+#include "../include/tally.h"
+#include "../include/resultSink.h"
+#include "../include/binaryOutput.h"
+#include "../include/query.h"
+#include "../include/roundStats.h"
+#include "../include/lengthHistogram.h"
+#include "../include/eventCounters.h"
+#include "../include/precision.h"
+#include "../include/checkpoint.h"
+#include "../include/sweep.h"
 
 using nlohmann::json;
 
+// Set when a run should end early. stopRequested keeps the pool from handing out more games;
+// abortRequested also stops the workers at their next game boundary. Both are lock-free, so
+// the signal handler may set them.
+static std::atomic<bool> stopRequested{false};
+static std::atomic<bool> abortRequested{false};
+static volatile std::sig_atomic_t stopSignal = 0;
+
 /**
- * @brief Main function that runs LCR (Left Center Right) game simulations
+ * @brief Ends the run at the next game boundary on SIGINT or SIGTERM.
  *
- * This function can operate in two modes:
- * 1. With JSON configuration file provided as command line argument
- * 2. With default hardcoded parameters if no JSON file is provided
+ * The default action is restored, so a second signal kills the process outright.
  *
- * The program supports multithreaded simulations with progress tracking,
- * strategy analysis, and CSV output of results.
+ * @param signal The signal received
+ */
+extern "C" void handleStopSignal(int signal) {
+    stopSignal = signal;
+    abortRequested.store(true, std::memory_order_relaxed);
+    stopRequested.store(true, std::memory_order_relaxed);
+    std::signal(signal, SIG_DFL);
+}
+
+/**
+ * @brief Solves the configured table exactly and prints win probabilities
  *
- * @param argc Number of command line arguments
- * @param argv Array of command line arguments, argv[1] should be JSON config file path
- * @return int Exit status (0 for success, 1 for error)
+ * Uses the same rules and steal targets as the simulator. Random strategies and a random
+ * starting player are averaged over every possibility. Solved tables are cached on disk.
+ *
+ * @param config Parsed configuration
+ * @return int Exit status (0 for success, 1 if the table is too large)
  */
-int main(int argc, char* argv[]) {
-    // --- Random ---
-    std::random_device rd;
-    std::mt19937 rng(rd());
+int runSolve(const Config& config) {
+    auto start = std::chrono::high_resolution_clock::now();
 
-    // -- Timer ---
+    Solver solver;
+    Solver::Solution solution;
+    try {
+        solution = solver.solveConfig(config);
+    } catch (const std::exception& e) {
+        std::cerr << "Solver error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    std::cout << "\nSolved " << solution.tables << " table(s) (" << solution.cachedTables << " from cache, "
+              << Helpers::formatWithCommas(static_cast<long long>(solution.states)) << " states) in " << elapsed.count() << "s" << std::endl;
+
+    const int columnWidth = 30;
+
+    std::vector<std::pair<std::string, double>> strategyWins = {
+            {"Steal From Highest", solution.strategyWins[Player::PlayStyle::StealFromHighest]},
+            {"Steal From Lowest", solution.strategyWins[Player::PlayStyle::StealFromLowest]},
+            {"Steal From Opposite", solution.strategyWins[Player::PlayStyle::StealFromOpposite]},
+            {"Steal Opposite Conditional", solution.strategyWins[Player::PlayStyle::StealOppositeConditional]}
+    };
+    std::sort(strategyWins.begin(), strategyWins.end(), [](const auto& a, const auto& b) {
+        return b.second < a.second;
+    });
+
+    std::cout << "\nExact win probability by strategy:" << std::endl;
+    for (const auto& [strategy, probability] : strategyWins) {
+        std::cout << "  " << std::left << std::setw(columnWidth) << strategy
+                  << std::fixed << std::setprecision(4) << probability * 100.0 << "%" << std::endl;
+    }
+    std::cout << "  " << std::left << std::setw(columnWidth) << "Draws"
+              << std::fixed << std::setprecision(4) << solution.draw * 100.0 << "%" << std::endl;
+
+    std::cout << "\nExact win probability by player:" << std::endl;
+    for (const Player& player : config.players) {
+        std::cout << "  " << std::left << std::setw(columnWidth) << player.getName()
+                  << "(" << Player::playStyleToString(player.getPlayStyle()) << ") "
+                  << std::fixed << std::setprecision(4) << solution.seatWins[player.getIndex()] * 100.0 << "%" << std::endl;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Describes a run for the header of its binary results file
+ *
+ * Holds everything that is the same for every game, so the per-game records only carry
+ * what varies. lcr-dump rebuilds the CSV columns from it.
+ *
+ * @param config Parsed configuration
+ * @param seed The run's seed
+ * @return json Header object
+ */
+json describeRun(const Config& config, uint64_t seed) {
+    json players = json::array();
+    for (const Player& player : config.players) {
+        players.push_back({{"name", player.getName()}, {"chips", player.getChips()}, {"strategy", player.getPlayStyle()}});
+    }
+    return {
+            {"seed", seed},
+            {"numSimulations", config.numSimulations},
+            {"runEachSim", config.runEachSim},
+            {"startingPlayer", config.startingPlayer},
+            {"players", players}
+    };
+}
+
+/**
+ * @brief Answers a group-by query over a binary results file without re-simulating
+ *
+ * `lcr query <results.lcrb> [--by seat|strategy|rounds|draw|none] [--seat N] [--strategy NAME]
+ * [--rounds N | --rounds A-B] [--draw yes|no]`. Seats are 1-based like startingPlayer; seat and
+ * strategy filters match the winner, so they leave out draws.
+ *
+ * @param argc Number of arguments after "query"
+ * @param argv Arguments after "query"
+ * @return int Exit status (0 for success, 1 on a bad file or arguments)
+ */
+int runQuery(int argc, char* argv[]) {
+    if (argc < 1) {
+        std::cerr << "Usage: lcr query <results.lcrb> [--by seat|strategy|rounds|draw|none] [--seat N] "
+                     "[--strategy NAME] [--rounds N|A-B] [--draw yes|no]" << std::endl;
+        return 1;
+    }
     auto start = std::chrono::high_resolution_clock::now();
 
-    // --- Initialize Game Parameters ---
-    int numSimulations;
-    Output::OutputType outputType = Output::OutputType::All;
-    int runEachSim;
-    bool randomStarter = false;
+    ResultQuery::Filter filter;
+    ResultQuery::GroupBy groupBy = ResultQuery::GroupBy::Seat;
+    try {
+        for (int i = 1; i < argc; i += 2) {
+            std::string option = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + option);
+            std::string value = argv[i + 1];
+
+            if (option == "--by") {
+                groupBy = ResultQuery::stringToGroupBy(value);
+            } else if (option == "--seat") {
+                filter.seat = ResultQuery::Range::only(std::stoi(value) - 1);
+            } else if (option == "--strategy") {
+                int style = 0;
+                while (style < Player::PlayStyle::Random && Player::playStyleToString(static_cast<Player::PlayStyle>(style)) != value) { style++; }
+                if (style == Player::PlayStyle::Random) throw std::invalid_argument("Unknown strategy: " + value);
+                filter.strategy = ResultQuery::Range::only(style);
+            } else if (option == "--rounds") {
+                size_t dash = value.find('-');
+                filter.rounds = dash == std::string::npos
+                        ? ResultQuery::Range::only(std::stoi(value))
+                        : ResultQuery::Range{std::stoi(value.substr(0, dash)), std::stoi(value.substr(dash + 1))};
+            } else if (option == "--draw") {
+                if (value != "yes" && value != "no") throw std::invalid_argument("--draw takes yes or no");
+                filter.draw = ResultQuery::Range::only(value == "yes" ? 1 : 0);
+            } else {
+                throw std::invalid_argument("Unknown option: " + option);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Query error: " << e.what() << std::endl;
+        return 1;
+    }
 
-    int barWidth = 70;
+    try {
+        ResultStore store(argv[0]);
+        int threads = std::thread::hardware_concurrency();
+        ThreadPool pool(threads > 0 ? threads : 4);
+        std::vector<ResultQuery::Row> rows = ResultQuery::run(store, filter, groupBy, pool);
+
+        std::vector<std::string> names;
+        for (const auto& player : store.header().at("players")) { names.push_back(player.at("name").get<std::string>()); }
+        auto label = [&](int64_t key) -> std::string {
+            switch (groupBy) {
+                case ResultQuery::GroupBy::Seat:
+                    if (key < 0) return "DRAW";
+                    return key < static_cast<int64_t>(names.size()) ? names[key] : "Seat " + std::to_string(key + 1);
+                case ResultQuery::GroupBy::Strategy:
+                    return key < 0 ? "DRAW" : Player::playStyleToString(static_cast<Player::PlayStyle>(key));
+                case ResultQuery::GroupBy::Draw:
+                    return key ? "draw" : "win";
+                case ResultQuery::GroupBy::Rounds:
+                    return std::to_string(key);
+                case ResultQuery::GroupBy::None:
+                default:
+                    return "all";
+            }
+        };
+
+        uint64_t matched = 0;
+        for (const auto& row : rows) { matched += row.games; }
+
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        std::cout << "Scanned " << Helpers::formatWithCommas(static_cast<long long>(store.numGames())) << " games in "
+                  << store.numBlocks() << " blocks (" << elapsed.count() << "s), "
+                  << Helpers::formatWithCommas(static_cast<long long>(matched)) << " matched\n" << std::endl;
+
+        const int columnWidth = 30;
+        std::cout << "  " << std::left << std::setw(columnWidth) << "group" << std::right << std::setw(15) << "games"
+                  << std::setw(10) << "share" << std::setw(14) << "mean rounds" << std::endl;
+        for (const auto& row : rows) {
+            double share = matched ? 100.0 * row.games / matched : 0.0;
+            std::cout << "  " << std::left << std::setw(columnWidth) << label(row.key) << std::right
+                      << std::setw(15) << Helpers::formatWithCommas(static_cast<long long>(row.games))
+                      << std::setw(9) << std::fixed << std::setprecision(2) << share << "%"
+                      << std::setw(14) << row.meanRounds() << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Query error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes the run's chips per seat per round for visualize_heatmap.py --rounds
+ *
+ * Rows are rounds (the last one collects every round past RoundStats::MaxRounds), columns
+ * are seats. Rounds no game reached are left out.
+ *
+ * @param stats Merged per-round sums
+ * @param roster The run's seats
+ * @param filename File to write
+ * @return bool False if the file could not be written
+ */
+bool exportRoundHeatmap(const RoundStats::Totals& stats, const Roster& roster, const std::string& filename) {
+    const int numSeats = roster.size();
+    int rows = RoundStats::Rows;
+    while (rows > 0 && stats.games[rows - 1] == 0) { rows--; }
+
+    json names = json::array();
+    for (int seat = 0; seat < numSeats; ++seat) { names.push_back(roster.name(seat)); }
+    json rounds = json::array(), games = json::array(), sums = json::array(), squares = json::array();
+    json means = json::array(), deviations = json::array();
+    for (int row = 0; row < rows; ++row) {
+        rounds.push_back(row < RoundStats::MaxRounds ? std::to_string(row + 1) : std::to_string(row + 1) + "+");
+        games.push_back(stats.games[row]);
+        json sumRow = json::array(), squareRow = json::array(), meanRow = json::array(), deviationRow = json::array();
+        for (int seat = 0; seat < numSeats; ++seat) {
+            const size_t cell = static_cast<size_t>(row) * numSeats + seat;
+            const double n = static_cast<double>(stats.games[row]);
+            const double mean = stats.sums[cell] / n;
+            sumRow.push_back(stats.sums[cell]);
+            squareRow.push_back(stats.squares[cell]);
+            meanRow.push_back(mean);
+            deviationRow.push_back(std::sqrt(std::max(0.0, stats.squares[cell] / n - mean * mean)));
+        }
+        sums.push_back(sumRow);
+        squares.push_back(squareRow);
+        means.push_back(meanRow);
+        deviations.push_back(deviationRow);
+    }
+
+    std::ofstream file(filename, std::ios::trunc);
+    file << json{{"seats", names}, {"rounds", rounds}, {"games", games}, {"mean", means}, {"stddev", deviations},
+                 {"sum", sums}, {"sumSquares", squares}}.dump() << std::endl;
+    file.close();
+    return !file.fail();
+}
+
+/**
+ * @brief Writes the non-empty game-length buckets of every group as CSV
+ *
+ * One row per bucket: group (winning strategy or Draw), the bucket's round range and its game count.
+ *
+ * @param series Merged histogram, indexed by LengthHistogram group
+ * @param filename File to write
+ * @return bool False if the file could not be written
+ */
+bool exportLengthHistogram(const std::vector<LengthHistogram::Series>& series, const std::string& filename) {
+    std::ofstream file(filename, std::ios::trunc);
+    file << "group,lowRounds,highRounds,games\n";
+    for (int group = 0; group < LengthHistogram::Groups; ++group) {
+        const std::string name = group == LengthHistogram::DrawGroup ? "Draw" : Player::playStyleToString(static_cast<Player::PlayStyle>(group));
+        for (int bucket = 0; bucket < LengthHistogram::Buckets; ++bucket) {
+            if (series[group].counts[bucket] == 0) continue;
+            file << name << "," << LengthHistogram::bucketLow(bucket) << "," << LengthHistogram::bucketHigh(bucket) << ","
+                 << series[group].counts[bucket] << "\n";
+        }
+    }
+    file.close();
+    return !file.fail();
+}
+
+/**
+ * @brief Prints the wins by strategy and by player and the game-length percentiles
+ *
+ * Shared by simulation runs and `lcr merge`, so merged shards read exactly like a single run.
+ *
+ * @param totals Merged win counts
+ * @param players The configured players, in seat order
+ * @param lengthSeries Merged game-length histograms, one per LengthHistogram group
+ * @param precision The run's precision target, or nullptr to leave out the confidence intervals
+ * @param maxGames The most games the run could play
+ */
+void printSummary(const Tally::Totals& totals, const std::vector<Player>& players,
+                  const std::vector<LengthHistogram::Series>& lengthSeries, const Precision* precision, int64_t maxGames) {
+    std::cout << "\nWins by strategy (sorted by most to least):" << std::endl;
+
+    const int columnWidth = 30;
+    const int numberWidth = 8;
 
+    std::vector<std::pair<std::string, uint64_t>> strategyWins = {
+            {"Steal From Highest", totals.strategyWins[Player::PlayStyle::StealFromHighest]},
+            {"Steal From Lowest", totals.strategyWins[Player::PlayStyle::StealFromLowest]},
+            {"Steal From Opposite", totals.strategyWins[Player::PlayStyle::StealFromOpposite]},
+            {"Steal Opposite Conditional", totals.strategyWins[Player::PlayStyle::StealOppositeConditional]}
+    };
+
+    std::sort(strategyWins.begin(), strategyWins.end(), [](const auto& a, const auto& b) {
+        return b.second < a.second;
+    });
+
+    uint64_t totalWins = totals.wins();
+    uint64_t totalGames = totals.games;
+    uint64_t draws = totals.draws;
+
+    for (const auto& [strategy, wins] : strategyWins) {
+        double percentage = (totalWins > 0) ? (static_cast<double>(wins) / (totalWins + draws)) * 100.0 : 0.0;
+        std::cout << "  " << std::left << std::setw(columnWidth) << strategy
+                  << std::setw(numberWidth) << Helpers::formatWithCommas(wins) << " "
+                  << std::fixed << std::setprecision(2) << percentage << "%" << std::endl;
+    }
+
+    double drawPercentage = (totalGames > 0) ? (static_cast<double>(draws) / totalGames) * 100.0 : 0.0;
+    std::cout << "  " << std::left << std::setw(columnWidth) << "Draws"
+              << std::setw(numberWidth) << Helpers::formatWithCommas(draws) << " "
+              << std::fixed << std::setprecision(2) << drawPercentage << "%" << std::endl;
+
+    std::cout << "\nWins by player:" << std::endl;
+    for (const Player& player : players) {
+        uint64_t playerWins = totals.seatWins[player.getIndex()];
+        double winPercentage = (totalWins > 0) ? (static_cast<double>(playerWins) / totalGames) * 100.0 : 0.0;
+        std::cout << "  " << std::left << std::setw(columnWidth) << player.getName()
+                  << std::setw(numberWidth) << Helpers::formatWithCommas(playerWins) << " ("
+                  << Player::playStyleToString(player.getPlayStyle()) << ") "
+                  << std::setprecision(2) << winPercentage << "%" << std::endl;
+    }
+
+    if (precision) {
+        const Precision::Target& target = precision->target();
+        std::cout << "\nWin rates with " << std::setprecision(1) << target.confidence * 100.0 << "% confidence intervals:" << std::endl;
+        for (const Precision::Interval& interval : precision->intervals(totals)) {
+            std::cout << "  " << std::left << std::setw(columnWidth) << interval.label << std::right << std::setprecision(3)
+                      << std::setw(8) << interval.estimate * 100.0 << "% +/-" << interval.halfWidth() * 100.0
+                      << "%  [" << interval.low * 100.0 << "%, " << interval.high * 100.0 << "%]" << std::endl;
+        }
+        if (precision->met(totals)) {
+            std::cout << "  Target of +/-" << target.halfWidth * 100.0 << "% reached after "
+                      << Helpers::formatWithCommas(static_cast<long long>(totals.games)) << " games." << std::endl;
+        } else {
+            std::cout << "  Target of +/-" << target.halfWidth * 100.0 << "% not reached within the limit of "
+                      << Helpers::formatWithCommas(maxGames) << " games (numSimulations * runEachSim)." << std::endl;
+        }
+    }
+
+    // Percentiles are the upper bound of the histogram bucket they fall in (exact below 64 rounds)
+    LengthHistogram::Series allLengths;
+    for (const auto& series : lengthSeries) { allLengths.add(series); }
+    std::vector<std::pair<std::string, const LengthHistogram::Series*>> lengthRows = {
+            {"All games", &allLengths},
+            {"Steal From Highest", &lengthSeries[Player::PlayStyle::StealFromHighest]},
+            {"Steal From Lowest", &lengthSeries[Player::PlayStyle::StealFromLowest]},
+            {"Steal From Opposite", &lengthSeries[Player::PlayStyle::StealFromOpposite]},
+            {"Steal Opposite Conditional", &lengthSeries[Player::PlayStyle::StealOppositeConditional]},
+            {"Draws", &lengthSeries[LengthHistogram::DrawGroup]}
+    };
+    std::cout << "\nGame length in rounds:" << std::endl;
+    std::cout << "  " << std::left << std::setw(columnWidth) << "" << std::right << std::setw(12) << "games"
+              << std::setw(8) << "p50" << std::setw(8) << "p90" << std::setw(8) << "p99" << std::setw(8) << "p99.9"
+              << std::setw(8) << "max" << std::endl;
+    for (const auto& [label, series] : lengthRows) {
+        std::cout << "  " << std::left << std::setw(columnWidth) << label << std::right
+                  << std::setw(12) << Helpers::formatWithCommas(static_cast<long long>(series->games))
+                  << std::setw(8) << series->quantile(0.5) << std::setw(8) << series->quantile(0.9)
+                  << std::setw(8) << series->quantile(0.99) << std::setw(8) << series->quantile(0.999)
+                  << std::setw(8) << series->longest << std::endl;
+    }
+}
+
+/**
+ * @brief Writes the Totals output row (wins per strategy), preceded by the header for a new file
+ *
+ * @param out The results CSV, opened for appending
+ * @param totals Merged win counts
+ * @param header Whether to write the column header first
+ */
+void writeTotalsRow(std::ostream& out, const Tally::Totals& totals, bool header) {
+    if (header) {
+        out << "Highest,Lowest,Opposite, Opposite Conditional" << std::endl;
+    }
+    out << totals.strategyWins[Player::PlayStyle::StealFromHighest] << ","
+        << totals.strategyWins[Player::PlayStyle::StealFromLowest] << ","
+        << totals.strategyWins[Player::PlayStyle::StealFromOpposite] << ","
+        << totals.strategyWins[Player::PlayStyle::StealOppositeConditional]
+        << std::endl;
+}
+
+/**
+ * @brief Combines the partial results of a sharded run into its summary and outputs
+ *
+ * `lcr merge <lcr_shard_i_of_N.json>...`. The partials must come from the same run and cover
+ * disjoint games; the summary, the Totals row and the histogram and heatmap exports are then
+ * the ones a single run would have produced. Shards that are missing or were stopped early
+ * are reported, and the results cover the games that were played.
+ *
+ * @param argc Number of arguments after "merge"
+ * @param argv Partial result files
+ * @return int Exit status (0 for success, 1 on unreadable or mismatched partials)
+ */
+int runMerge(int argc, char* argv[]) {
+    if (argc < 1) {
+        std::cerr << "Usage: lcr merge <partial.json>..." << std::endl;
+        return 1;
+    }
+
+    Checkpoint merged;
     std::vector<Player> players;
+    int64_t totalGames = 0;
+    try {
+        merged = Checkpoint::load(argv[0]);
+        for (int i = 1; i < argc; ++i) {
+            merged.merge(Checkpoint::load(argv[i]));
+        }
 
-    int startingPlayer = 1;
+        const json& run = merged.run;
+        const json& seats = run.at("players");
+        for (size_t seat = 0; seat < seats.size(); ++seat) {
+            players.emplace_back(seats[seat].at("name").get<std::string>(), seats[seat].at("chips").get<int>(), static_cast<int>(seat),
+                                 seats[seat].at("strategy").get<Player::PlayStyle>(), static_cast<int>(seats.size()));
+        }
+        totalGames = run.at("numSimulations").get<int64_t>() * run.at("runEachSim").get<int64_t>();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
 
-    if (argc > 1) {
-        std::string jsonFilePath = argv[1];
-        std::ifstream jsonFile(jsonFilePath);
-        if (jsonFile.is_open()) {
-            try {
-                json configData;
-                jsonFile >> configData;
+    const uint64_t covered = merged.gamesCompleted();
+    std::cout << "Merged " << argc << " partial result files (seed " << merged.run.at("seed").get<uint64_t>() << "): "
+              << Helpers::formatWithCommas(static_cast<long long>(covered)) << " of " << Helpers::formatWithCommas(totalGames) << " games." << std::endl;
+    for (const Checkpoint::Range& gap : merged.missing(0, totalGames)) {
+        std::cout << "  Missing games " << Helpers::formatWithCommas(gap.first) << " to " << Helpers::formatWithCommas(gap.second - 1) << std::endl;
+    }
 
-                // Read the number of simulations
-                numSimulations = configData.at("numSimulations").get<int>();
+    printSummary(merged.tally, players, merged.lengths, nullptr, totalGames);
 
-                startingPlayer = configData.at("startingPlayer").get<int>();
+    const std::string outputFilename = "lcr_simulation_results.csv";
+    const bool writeHeader = !std::filesystem::exists(outputFilename);
+    std::ofstream outFile(outputFilename, std::ios::app);
+    writeTotalsRow(outFile, merged.tally, writeHeader);
+    outFile.close();
+    if (outFile.fail()) {
+        std::cerr << "File I/O Error: Could not write to " << outputFilename << std::endl;
+        return 1;
+    }
+    std::cout << "Results successfully exported to " << outputFilename << "." << std::endl;
 
-                outputType = Output::stringToOutputType(configData.at("outputType").get<std::string>());
+    if (merged.lengthHistogram) {
+        const std::string histogramFilename = "lcr_length_histogram.csv";
+        if (!exportLengthHistogram(merged.lengths, histogramFilename)) {
+            std::cerr << "File I/O Error: Could not write to " << histogramFilename << std::endl;
+            return 1;
+        }
+        std::cout << "Game-length histogram exported to " << histogramFilename << "." << std::endl;
+    }
+    if (merged.rounds) {
+        const std::string heatmapFilename = "lcr_round_heatmap.json";
+        if (!exportRoundHeatmap(*merged.rounds, Roster(players), heatmapFilename)) {
+            std::cerr << "File I/O Error: Could not write to " << heatmapFilename << std::endl;
+            return 1;
+        }
+        std::cout << "Round heatmap exported to " << heatmapFilename << "." << std::endl;
+    }
+    return 0;
+}
 
-                runEachSim = configData.at("runEachSim").get<int>();
+/**
+ * @brief Plays every cell of the configured sweep on one pool and writes one row per cell
+ *
+ * Each cell is the base table with the sweep's values substituted, and plays numSimulations *
+ * runEachSim games from the run's seed on the configured engine. The cells' games are
+ * interleaved in chunks of about equal cost (see Sweep::schedule). A time budget or a signal
+ * stops every cell at a game boundary; each row then covers the games its cell finished.
+ *
+ * @param config Parsed configuration with a sweep
+ * @param seed The run's seed
+ * @return int Exit status (0 for success, 1 on an invalid grid or unwritable results, 128 + signal if interrupted)
+ */
+int runSweep(const Config& config, uint64_t seed) {
+    auto start = std::chrono::high_resolution_clock::now();
 
-                int totalPlayers = configData.at("totalPlayers").get<int>();
+    std::vector<Sweep::Cell> cells;
+    try {
+        // One table's outputs do not apply to a grid of them
+        if (config.outputType != Output::OutputType::Totals || config.jsonOutput || config.precision || config.roundHeatmap ||
+            config.lengthHistogram || config.checkpointSeconds) {
+            throw std::runtime_error("sweep needs outputType Totals without jsonOutput, precision, roundHeatmap, lengthHistogram or checkpointSeconds");
+        }
+        cells = Sweep::expand(*config.sweep, config.players, config.startingPlayer);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    const int64_t gamesPerCell = static_cast<int64_t>(config.numSimulations) * config.runEachSim;
+    if (gamesPerCell > std::numeric_limits<int>::max()) {
+        std::cerr << "Too many games: numSimulations * runEachSim must not exceed " << std::numeric_limits<int>::max() << std::endl;
+        return 1;
+    }
+    const int64_t totalGames = gamesPerCell * static_cast<int64_t>(cells.size());
 
-                // Read the players array
-                int index = 0;
-                for (const auto& player : configData.at("players")) {
-                    std::string name = player.at("name").get<std::string>();
-                    int chips = player.at("chips").get<int>();
-                    Player::PlayStyle strategy;
+    int maxThreads = std::thread::hardware_concurrency();
+    maxThreads = maxThreads > 0 ? maxThreads : 4;
+    ThreadPool pool(maxThreads);
 
-                    if (player.at("strategy").get<int>() == -1) {
-                        strategy = Player::PlayStyle::Random;
-                    } else {
-                        strategy = static_cast<Player::PlayStyle>(player.at("strategy").get<int>() - 1);
-                    }
+    // A cell's table and deals, shared by its games, and its counts
+    struct CellRun {
+        Roster roster;
+        BatchTable batches;
+        Tally tally;
+        std::atomic<int64_t> played{0};
+        std::atomic<uint64_t> rounds{0};
+
+        CellRun(const Sweep::Cell& cell, const Config& config, uint64_t seed, int numWorkers)
+                : roster(cell.players), batches(roster, seed, config.numSimulations, config.runEachSim, cell.startingPlayer),
+                  tally(numWorkers, roster.size()) {}
+    };
+    std::vector<std::unique_ptr<CellRun>> runs;
+    for (const Sweep::Cell& cell : cells) {
+        runs.push_back(std::make_unique<CellRun>(cell, config, seed, maxThreads));
+    }
+    const std::vector<Sweep::Chunk> chunks = Sweep::schedule(cells, gamesPerCell, maxThreads);
 
-                    players.emplace_back(name, chips, index, strategy, totalPlayers);
+    std::cout << "\nRunning a sweep of " << cells.size() << " cells, " << Helpers::formatWithCommas(gamesPerCell)
+              << " games each (seed " << seed << ")..." << std::endl;
 
-                    index++;
-                }
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    std::atomic<bool> timedOut{false};
+    std::atomic<bool> runFinished{false};
+    std::atomic<int64_t> totalGamesRun{0};
+    std::atomic<int> cellsDone{0};
 
-                std::cout << "Imported " << players.size() << " players and " << numSimulations << " simulations from JSON file." << std::endl;
+    // One status line, rewritten 5 times a second; also enforces the time budget
+    std::thread progressThread([&]() {
+        using namespace std::chrono;
+        auto startTime = high_resolution_clock::now();
+        while (!runFinished.load()) {
+            const double elapsed = duration<double>(high_resolution_clock::now() - startTime).count();
+            if (config.maxSeconds && !timedOut && elapsed >= *config.maxSeconds) {
+                timedOut = true;
+                abortRequested.store(true, std::memory_order_relaxed);
+                stopRequested.store(true, std::memory_order_relaxed);
+            }
+            const long long gamesRun = totalGamesRun.load(std::memory_order_relaxed);
+            std::cout << "\rCells done: " << cellsDone.load() << "/" << cells.size() << " | Games: "
+                      << Helpers::formatWithCommas(gamesRun) << "/" << Helpers::formatWithCommas(totalGames) << " | Rate: "
+                      << std::fixed << std::setprecision(1) << (elapsed > 0.5 ? gamesRun / elapsed : 0.0) << " sims/sec   " << std::flush;
+            std::this_thread::sleep_for(milliseconds(200));
+        }
+        std::cout << "\rCells done: " << cellsDone.load() << "/" << cells.size() << " | Games: "
+                  << Helpers::formatWithCommas(totalGamesRun.load()) << "/" << Helpers::formatWithCommas(totalGames)
+                  << std::string(24, ' ') << std::endl;
+    });
+
+    // Game ids are per cell, so every cell's games draw from the same streams as a plain run of its table
+    const bool specialized = config.engine == Config::Engine::Specialized;
+    auto playChunk = [&](int64_t firstChunk, int64_t lastChunk) {
+        const int worker = ThreadPool::currentWorker();
+        for (int64_t index = firstChunk; index < lastChunk && !abortRequested.load(std::memory_order_relaxed); ++index) {
+            const Sweep::Chunk& chunk = chunks[index];
+            CellRun& run = *runs[chunk.cell];
+            int64_t finished = chunk.last;
+            uint64_t rounds = 0;
+            auto record = [&](const Result& result) {
+                run.tally.add(worker, result);
+                rounds += result.numberOfRounds;
+            };
+            try {
+                if (config.engine == Config::Engine::Lockstep) {
+                    thread_local LockstepEngine engine;
+                    finished = engine.play(run.roster, seed, static_cast<int>(chunk.first), static_cast<int>(chunk.last),
+                                [&](int gameId) {
+                                    int batch = run.batches.batchOf(gameId);
+                                    return LockstepEngine::Deal{&run.batches.strategies(batch), run.batches.startSeat(batch)};
+                                },
+                                record, nullptr, &abortRequested);
+                } else {
+                    thread_local GameState state;
+                    for (int gameId = static_cast<int>(chunk.first); gameId < chunk.last; ++gameId) {
+                        if (abortRequested.load(std::memory_order_relaxed)) {
+                            finished = gameId;
+                            break;
+                        }
+                        int batch = run.batches.batchOf(gameId);
+                        state.reset(run.roster, run.batches.strategies(batch), run.batches.startSeat(batch));
+                        Rng rng(seed, gameId);
+                        record(specialized ? Kernels::play(gameId, state, rng) : Game(state).play(gameId, rng));
+                    }
+                }
             } catch (const std::exception& e) {
-                std::cerr << "Error parsing JSON file: " << e.what() << std::endl;
+                std::cerr << "Error during simulation: " << e.what() << std::endl;
+            }
+
+            run.rounds.fetch_add(rounds, std::memory_order_relaxed);
+            totalGamesRun.fetch_add(finished - chunk.first, std::memory_order_relaxed);
+            if (run.played.fetch_add(finished - chunk.first) + (finished - chunk.first) == gamesPerCell) {
+                cellsDone++;
+            }
+        }
+    };
+    pool.parallelFor(0, static_cast<int64_t>(chunks.size()), 1, playChunk, stopRequested);
+
+    runFinished = true;
+    progressThread.join();
+
+    std::chrono::duration<double> elapsedSinceStart = std::chrono::high_resolution_clock::now() - start;
+    const bool stoppedEarly = stopSignal != 0 || timedOut;
+    std::cout << (stoppedEarly ? "\nSweep stopped. " : "\nSweep complete. ")
+              << Helpers::formatWithCommas(totalGamesRun.load()) << " simulations ran in "
+              << elapsedSinceStart.count() << "s" << std::endl;
+    if (stoppedEarly) {
+        std::cout << "Stopped early (";
+        if (timedOut) std::cout << "time budget of " << std::defaultfloat << std::setprecision(6) << *config.maxSeconds << "s reached";
+        else std::cout << (stopSignal == SIGINT ? "SIGINT" : "SIGTERM");
+        std::cout << "): each cell's results cover the games it finished." << std::endl;
+    }
+
+    // --- Display Results ---
+    // Win rates are shares of the cell's games; the CSV keeps the counts
+    std::cout << "\nWin rate by strategy for each cell:" << std::endl;
+    std::cout << "  " << std::right << std::setw(5) << "cell" << std::setw(8) << "seats" << std::setw(8) << "chips"
+              << std::setw(12) << "strategies" << std::setw(7) << "start" << std::setw(14) << "games"
+              << std::setw(10) << "Highest" << std::setw(10) << "Lowest" << std::setw(10) << "Opposite"
+              << std::setw(12) << "Opp. Cond." << std::setw(9) << "Draws" << std::setw(9) << "Rounds" << std::endl;
+    std::vector<Tally::Totals> totals;
+    for (size_t cell = 0; cell < cells.size(); ++cell) {
+        totals.push_back(runs[cell]->tally.merge());
+        const Tally::Totals& cellTotals = totals.back();
+        const double games = std::max<double>(static_cast<double>(cellTotals.games), 1.0);
+        std::cout << "  " << std::setw(5) << cell + 1 << std::setw(8) << cells[cell].totalPlayers << std::setw(8) << cells[cell].chips
+                  << std::setw(12) << cells[cell].strategies << std::setw(7)
+                  << (cells[cell].startingPlayer < 0 ? std::string("random") : std::to_string(cells[cell].startingPlayer))
+                  << std::setw(14) << Helpers::formatWithCommas(static_cast<long long>(cellTotals.games)) << std::fixed << std::setprecision(2);
+        for (Player::PlayStyle strategy : {Player::PlayStyle::StealFromHighest, Player::PlayStyle::StealFromLowest,
+                                           Player::PlayStyle::StealFromOpposite, Player::PlayStyle::StealOppositeConditional}) {
+            std::cout << std::setw(strategy == Player::PlayStyle::StealOppositeConditional ? 11 : 9)
+                      << cellTotals.strategyWins[strategy] / games * 100.0 << "%";
+        }
+        std::cout << std::setw(8) << cellTotals.draws / games * 100.0 << "%" << std::setw(9)
+                  << runs[cell]->rounds.load() / games << std::endl;
+    }
+
+    // --- Export Results to CSV ---
+    // One row per cell, replaced on every sweep
+    const std::string sweepFilename = "lcr_sweep_results.csv";
+    std::ofstream file(sweepFilename, std::ios::trunc);
+    file << "cell,totalPlayers,chips,strategies,startingPlayer,games,draws,Highest,Lowest,Opposite,Opposite Conditional,meanRounds\n";
+    for (size_t cell = 0; cell < cells.size(); ++cell) {
+        const Tally::Totals& cellTotals = totals[cell];
+        file << cell + 1 << "," << cells[cell].totalPlayers << "," << cells[cell].chips << "," << cells[cell].strategies << ","
+             << cells[cell].startingPlayer << "," << cellTotals.games << "," << cellTotals.draws << ","
+             << cellTotals.strategyWins[Player::PlayStyle::StealFromHighest] << ","
+             << cellTotals.strategyWins[Player::PlayStyle::StealFromLowest] << ","
+             << cellTotals.strategyWins[Player::PlayStyle::StealFromOpposite] << ","
+             << cellTotals.strategyWins[Player::PlayStyle::StealOppositeConditional] << ","
+             << std::setprecision(4) << (cellTotals.games > 0 ? runs[cell]->rounds.load() / static_cast<double>(cellTotals.games) : 0.0) << "\n";
+    }
+    file.close();
+    if (file.fail()) {
+        std::cerr << "File I/O Error: Could not write to " << sweepFilename << std::endl;
+        return 1;
+    }
+    std::cout << "Results successfully exported to " << sweepFilename << "." << std::endl;
+
+    return stopSignal != 0 ? 128 + stopSignal : 0;
+}
+
+/**
+ * @brief Main function that runs LCR (Left Center Right) game simulations
+ *
+ * This function can operate in two modes:
+ * 1. With JSON configuration file provided as command line argument
+ * 2. With default hardcoded parameters if no JSON file is provided
+ *
+ * Passing "solve" as the first argument (`lcr solve [config]`) computes exact
+ * win probabilities with the Markov chain solver instead of simulating, and
+ * `lcr query <results.lcrb> ...` aggregates a Binary output file (see runQuery).
+ * A config with a "sweep" section plays a grid of table variations instead (see runSweep).
+ *
+ * The program supports multithreaded simulations with progress tracking,
+ * strategy analysis, and CSV output of results.
+ *
+ * @param argc Number of command line arguments
+ * @param argv Array of command line arguments, argv[1] should be JSON config file path (or "solve")
+ * @return int Exit status (0 for success, 1 for error)
+ */
+int main(int argc, char* argv[]) {
+    // --- Mode ---
+    // `lcr query <file> ...` aggregates a previous run's Binary output
+    if (argc > 1 && std::string(argv[1]) == "query") {
+        return runQuery(argc - 2, argv + 2);
+    }
+
+    // `lcr solve <config>` computes exact win probabilities instead of simulating
+    bool solveMode = argc > 1 && std::string(argv[1]) == "solve";
+    int configArg = solveMode ? 2 : 1;
+
+    // `lcr merge <partial files>` combines the shards of a run
+    if (argc > 1 && std::string(argv[1]) == "merge") {
+        return runMerge(argc - 2, argv + 2);
+    }
+
+    // `lcr <config> --resume` carries on from the run saved in the checkpoint file;
+    // `--shard i/N` plays the i-th of N slices of the batches (0 <= i < N) of a run with a fixed seed
+    bool resume = false;
+    std::optional<std::pair<int, int>> shard;
+    std::string configPath;
+    for (int i = configArg; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--resume") {
+            resume = true;
+        } else if (arg == "--shard") {
+            int index = -1, count = 0;
+            char end = 0;
+            if (i + 1 >= argc || std::sscanf(argv[i + 1], "%d/%d%c", &index, &count, &end) != 2 || count < 1 || index < 0 || index >= count) {
+                std::cerr << "--shard takes i/N with 0 <= i < N" << std::endl;
                 return 1;
             }
-        } else {
-            std::cerr << "Error opening JSON file: " << jsonFilePath << std::endl;
+            shard = std::make_pair(index, count);
+            ++i;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option: " << arg << std::endl;
             return 1;
+        } else if (configPath.empty()) {
+            configPath = arg;
         }
+    }
+
+    // -- Timer ---
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // --- Initialize Game Parameters ---
+    Config config;
+    if (!configPath.empty()) {
+        try {
+            config = Config::load(configPath);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Imported " << config.players.size() << " players and " << config.numSimulations << " simulations from JSON file." << std::endl;
     } else {
         std::cout << "No JSON file provided" << std::endl;
+        config = Config::defaults();
+    }
 
-        numSimulations = 10'000;
-        startingPlayer = -1;
-        randomStarter = false;
-        outputType = Output::OutputType::Totals;
-        runEachSim = 100;
-
-        players = {
-            Player("Player 1", 3, 0, Player::Random, 10),
-            Player("Player 2", 3, 1, Player::Random, 10),
-            Player("Player 3", 3, 2, Player::Random, 10),
-            Player("Player 4", 3, 3, Player::Random, 10),
-            Player("Player 5", 3, 4, Player::Random, 10),
-            Player("Player 6", 3, 5, Player::Random, 10),
-            Player("Player 7", 3, 6, Player::Random, 10),
-            Player("Player 8", 3, 7, Player::Random, 10),
-            Player("Player 9", 3, 8, Player::Random, 10),
-            Player("Player 10", 3, 9, Player::Random, 10),
-        };
+    if (solveMode) {
+        return runSolve(config);
+    }
+
+    // --- Random ---
+    // Every game draws from its own counter-based stream derived from this seed,
+    // so a run is reproducible from the seed alone. Overridden by "seed" in the config.
+    std::random_device rd;
+    uint64_t seed = config.seed ? *config.seed : (static_cast<uint64_t>(rd()) << 32) | rd();
+
+    // A sweep plays its grid of tables in place of the configured one
+    if (config.sweep) {
+        if (resume || shard) {
+            std::cerr << "A sweep cannot be resumed or sharded" << std::endl;
+            return 1;
+        }
+        return runSweep(config, seed);
+    }
+
+    // --- Checkpoints ---
+    // The merged aggregates and the game ids they cover are saved every checkpointSeconds and
+    // when a run is stopped early, and removed once it completes. A resumed run takes its seed
+    // from the checkpoint and must otherwise be configured exactly as the run it continues.
+    // Each shard of a sharded run keeps its own checkpoint, and ends by writing its partial
+    // results (the same aggregates) for `lcr merge`.
+    const std::string shardSuffix = shard ? "_" + std::to_string(shard->first) + "_of_" + std::to_string(shard->second) : "";
+    const std::string checkpointFilename = "lcr_checkpoint" + shardSuffix + ".json";
+    const std::string partialFilename = "lcr_shard" + shardSuffix + ".json";
+    const bool checkpointing = resume || config.checkpointSeconds.has_value();
+    Checkpoint checkpoint;
+    try {
+        if (resume) {
+            checkpoint = Checkpoint::load(checkpointFilename);
+            if (!config.seed) seed = checkpoint.run.at("seed").get<uint64_t>();
+            if (Checkpoint::runHash(describeRun(config, seed)) != Checkpoint::runHash(checkpoint.run)) {
+                throw std::runtime_error(checkpointFilename + " is from a run with a different configuration or seed");
+            }
+            if (checkpoint.rounds.has_value() != config.roundHeatmap) {
+                throw std::runtime_error(checkpointFilename + " is from a run with roundHeatmap " + (config.roundHeatmap ? "off" : "on"));
+            }
+        }
+        // Per-game records written after the last checkpoint would be written again on resuming
+        if (checkpointing && (config.outputType != Output::OutputType::Totals || config.jsonOutput)) {
+            throw std::runtime_error("Checkpoints need outputType Totals without jsonOutput");
+        }
+        // Shards leave every output to `lcr merge`; a precision target is for the whole run
+        if (shard && (config.outputType != Output::OutputType::Totals || config.jsonOutput || config.precision)) {
+            throw std::runtime_error("--shard needs outputType Totals without jsonOutput or precision");
+        }
+        // Every shard must play the same run's streams, which a random seed per process would not
+        if (shard && !config.seed) {
+            throw std::runtime_error("--shard needs a seed in the config so the shards play the same run");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
     }
+    checkpoint.run = describeRun(config, seed);
+    checkpoint.lengthHistogram = config.lengthHistogram;
+    checkpoint.shard = shard;
+
+    int numSimulations = config.numSimulations;
+    Output::OutputType outputType = config.outputType;
+    int runEachSim = config.runEachSim;
+    int startingPlayer = config.startingPlayer;
+    std::vector<Player> players = config.players;
+    const bool specialized = config.engine == Config::Engine::Specialized;
+
+    int barWidth = 70;
 
     // --- Run Simulations ---
-    std::vector<Result> allResults;
-    allResults.reserve(numSimulations * (runEachSim));
-    std::mutex results_mutex; // Protect access to allResults
+    std::atomic<int64_t> totalGamesRun{0};
+    std::cout << "\nRunning simulations (seed " << seed << ")..." << std::endl;
 
-    std::atomic<int> totalGamesRun{0};
-    std::cout << "\nRunning simulations..." << std::endl;
+    // Names, starting chips and configured strategies, shared read-only by every game
+    Roster roster(players);
 
-    if (startingPlayer < 0) {
-        randomStarter = true;
-        std::uniform_int_distribution<int> playerDist(1, players.size());
-        startingPlayer = playerDist(rng);
+    // Game ids are ints, so the run is capped at INT_MAX games
+    int64_t totalSimulations = static_cast<int64_t>(numSimulations) * runEachSim;
+    if (totalSimulations > std::numeric_limits<int>::max()) {
+        std::cerr << "Too many games: numSimulations * runEachSim must not exceed " << std::numeric_limits<int>::max() << std::endl;
+        return 1;
     }
-    std::rotate(players.begin(), players.begin() + startingPlayer - 1, players.end());
 
-    int totalSimulations = numSimulations * (runEachSim);
+    // The game ids this process plays: a shard takes a contiguous slice of the batches, so its
+    // games are the same ones, on the same streams, as in the unsharded run
+    int64_t runBegin = 0;
+    int64_t runEnd = totalSimulations;
+    if (shard) {
+        runBegin = static_cast<int64_t>(numSimulations) * shard->first / shard->second * runEachSim;
+        runEnd = static_cast<int64_t>(numSimulations) * (shard->first + 1) / shard->second * runEachSim;
+        std::cout << "Shard " << shard->first << " of " << shard->second << ": games " << Helpers::formatWithCommas(runBegin)
+                  << " to " << Helpers::formatWithCommas(runEnd - 1) << "." << std::endl;
+    }
+    const int64_t runGames = runEnd - runBegin;
     int maxThreads = std::thread::hardware_concurrency(); // Use available CPU cores
     maxThreads = maxThreads > 0 ? maxThreads : 4; // Fallback if detection fails
 
     ThreadPool pool(maxThreads);
 
-    // Create atomic counters for tracking wins by strategy
-    std::atomic<int> winsStealFromHighest{0};
-    std::atomic<int> winsStealFromLowest{0};
-    std::atomic<int> winsStealFromOpposite{0};
-    std::atomic<int> winsStealOppositeConditional{0};
+    // Per-worker win counters by strategy and seat, merged for the progress display and the summary
+    Tally tally(maxThreads, roster.size());
 
-    std::mutex playerMutex; // For updating player win counts
+    // Starting seat and concrete strategies for every batch, shared by all of its replays
+    const BatchTable batches(roster, seed, numSimulations, runEachSim, startingPlayer);
 
-    // Submit all tasks to thread pool
-    for (int i = 0; i < numSimulations; ++i) {
-        std::vector<Player> batchPlayers = players;
-        int batchStartingPlayer = startingPlayer;
-
-        // Randomize once per batch (not per simulation)
-        std::random_device batch_rd;
-        std::mt19937 batch_rng(batch_rd());
+    // Per-game records hold the winning seat in 16 bits
+    if ((outputType != Output::OutputType::Totals || config.jsonOutput) && roster.size() > GameRecord::MaxSeats) {
+        std::cerr << "Per-game output supports at most " << GameRecord::MaxSeats << " players; use outputType Totals" << std::endl;
+        return 1;
+    }
 
-        // Set random starting player for this batch
-        if (randomStarter) {
-            std::uniform_int_distribution<int> playerDist(1, players.size());
-            batchStartingPlayer = playerDist(batch_rng);
+    // --- Output ---
+    // Per-game records (All, Binary) are streamed to the file by a writer thread while the games
+    // run, so memory does not grow with the number of games. Totals needs no per-game records.
+    // The CSV is appended to across runs; a binary file describes a single run and is replaced.
+    // A shard writes only its partial results, and a checkpointed run opens the CSV only once it
+    // has completed, so an interrupted one leaves no file behind.
+    const bool binaryOutput = outputType == Output::OutputType::Binary;
+    std::string outputFilename = binaryOutput ? "lcr_simulation_results.lcrb" : "lcr_simulation_results.csv";
+    bool writeHeader = !std::filesystem::exists(outputFilename);
+    std::ofstream outFile;
+    if (!shard && !checkpointing) {
+        outFile.open(outputFilename, binaryOutput ? std::ios::binary | std::ios::trunc : std::ios::app);
+        if (!outFile.is_open()) {
+            std::cerr << "File I/O Error: Could not open file for writing: " << outputFilename << std::endl;
+            return 1;
         }
+    }
 
-        // Set random strategies for this batch
-        for (Player &p : batchPlayers) {
-            if (p.getPlayStyle() == Player::PlayStyle::Random) {
-                std::uniform_int_distribution<int> dist(0, Player::PlayStyle::StealOppositeConditional);
-                p.setStrategy(static_cast<Player::PlayStyle>(dist(batch_rng)));
-            }
+    RecordWriterGroup recordWriters;
+    if (outputType == Output::OutputType::All) {
+        if (writeHeader) {
+            outFile << CsvRecordWriter::Header << '\n';
         }
+        recordWriters.add(std::make_unique<CsvRecordWriter>(outFile, roster));
+    } else if (binaryOutput) {
+        recordWriters.add(std::make_unique<BinaryRecordWriter>(outFile, describeRun(config, seed), config.compressOutput));
+    }
 
-        for (int j = 0; j < runEachSim; ++j) {
-            pool.enqueue([&, batchPlayers, batchStartingPlayer]() {
-                try {
-                    // Create identical copy for this replay
-                    std::vector<Player> simPlayers = batchPlayers;
-
-                    // Apply the same starting player rotation for all replays in this batch
-                    if (batchStartingPlayer != startingPlayer) {
-                        std::rotate(simPlayers.begin(), simPlayers.begin() + batchStartingPlayer - 1, simPlayers.end());
-                    }
-
-                    Game lcrGame(simPlayers);
-                    int gameId = totalGamesRun.fetch_add(1);
+    // Per-game JSON for visualize_heatmap.py, written next to the configured output.
+    // Sampled games are replayed with a recorder once they finish, so the chip histories cost
+    // nothing on the games that are not recorded.
+    std::string jsonFilename = "lcr_simulation_results.json";
+    std::ofstream jsonFile;
+    std::unique_ptr<ChipHistoryStore> histories;
+    if (config.jsonOutput) {
+        jsonFile.open(jsonFilename, std::ios::trunc);
+        if (!jsonFile.is_open()) {
+            std::cerr << "File I/O Error: Could not open file for writing: " << jsonFilename << std::endl;
+            return 1;
+        }
+        if (config.history.enabled()) {
+            histories = std::make_unique<ChipHistoryStore>(maxThreads, config.history);
+        }
+        recordWriters.add(std::make_unique<JsonRecordWriter>(jsonFile, roster, batches, histories.get()));
+    } else if (config.history.enabled()) {
+        std::cerr << "recordHistory is ignored without jsonOutput" << std::endl;
+    }
 
-                    // Play the game and store the result
-                    Result result = lcrGame.play(gameId);
-
-                    // Update strategy win counts
-                    if (!result.draw) {
-                        if (result.winnerStrategy == Player::PlayStyle::StealFromHighest) {
-                            winsStealFromHighest++;
-                        } else if (result.winnerStrategy == Player::PlayStyle::StealFromLowest) {
-                            winsStealFromLowest++;
-                        } else if (result.winnerStrategy == Player::PlayStyle::StealFromOpposite) {
-                            winsStealFromOpposite++;
-                        } else if (result.winnerStrategy == Player::PlayStyle::StealOppositeConditional) {
-                            winsStealOppositeConditional++;
-                        }
-                    }
+    std::unique_ptr<ResultSink> sink;
+    if (!recordWriters.empty()) {
+        sink = std::make_unique<ResultSink>(maxThreads, recordWriters);
+    }
 
-                    {
-                        std::lock_guard<std::mutex> lock(playerMutex);
-                        // Update player win count
-                        auto it = std::find_if(players.begin(), players.end(), [&result](const Player &p) {
-                            return p.getName() == result.winnerName;
-                        });
+    // Per-worker chips per seat per round, summed over every game
+    std::unique_ptr<RoundStats> roundStats;
+    if (config.roundHeatmap) {
+        roundStats = std::make_unique<RoundStats>(maxThreads, roster.size());
+    }
 
-                        if (it != players.end()) {
-                            it->addWin();
-                        }
-                    }
+    // Per-worker game lengths by winning strategy and draws
+    LengthHistogram lengths(maxThreads);
+
+    // A resumed run starts from the checkpoint's counts
+    const int64_t resumedGames = static_cast<int64_t>(checkpoint.gamesCompleted());
+    if (resume) {
+        tally.restore(checkpoint.tally);
+        lengths.restore(checkpoint.lengths);
+        if (roundStats) roundStats->restore(*checkpoint.rounds);
+        totalGamesRun = resumedGames;
+        std::cout << "Resuming from " << checkpointFilename << ": " << Helpers::formatWithCommas(resumedGames)
+                  << " games already played." << std::endl;
+    }
 
-                    {
-                        std::lock_guard<std::mutex> lock(results_mutex);
-                        allResults.push_back(result);
-                    }
-                } catch (const std::exception &e) {
-                    std::cerr << "Error during simulation: " << e.what() << std::endl;
-                }
-            });
+    // With a precision target the run is played up to one check at a time (Precision::nextCheck)
+    // and the target is tested between them, once every game before the check has finished.
+    // The games that ran are then a prefix of the game ids whose length does not depend on
+    // timing, and the workers never merge the tally.
+    std::unique_ptr<Precision> precision;
+    bool targetReached = false;
+    if (config.precision) {
+        try {
+            precision = std::make_unique<Precision>(roster, *config.precision);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
         }
     }
 
+    // A time budget or a signal ends the run at a game boundary; everything finished so far
+    // is still summarised and exported
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    std::atomic<bool> timedOut{false};
+    std::atomic<bool> checkpointDue{false}; // Pauses the pool so a consistent checkpoint can be saved
+    std::atomic<bool> runFinished{false};
+
+    // Tallies a finished game; runs on a pool worker
+    auto record = [&](const Result& result) {
+        int worker = ThreadPool::currentWorker();
+        tally.add(worker, result);
+        lengths.add(worker, result);
+        if (sink) {
+            const int batch = batches.batchOf(result.gameId);
+            const GameRecord gameRecord = GameRecord::from(result, batch);
+            if (histories && histories->sampler().selects(gameRecord)) {
+                // Same deal and dice stream as the game just played, on the generic engine. Its
+                // events were counted when it was played.
+                EventCounters::Mute mute;
+                thread_local GameState replayState;
+                thread_local ChipRecorder recorder;
+                replayState.reset(roster, batches.strategies(batch), batches.startSeat(batch));
+                Rng replayRng(seed, result.gameId);
+                Game(replayState).play(result.gameId, replayRng, &recorder);
+                histories->add(worker, result.gameId, recorder);
+            }
+            sink->push(worker, gameRecord);
+        }
+    };
+
     // Progress bar update thread
     std::thread progressThread([&]() {
         using namespace std::chrono;
@@ -230,10 +1017,37 @@ int main(int argc, char* argv[]) {
         long long lastGamesRun = 0;
         double simsPerSecond = 0.0;
 
-        while (true) {
+        double lastCheckpoint = 0.0;
+
+        while (!runFinished.load()) {
             long long currentGamesRun = totalGamesRun.load(std::memory_order_relaxed);
-            if (currentGamesRun >= totalSimulations) {
-                break;
+
+            const double elapsed = duration<double>(high_resolution_clock::now() - startTime).count();
+            double secondsLeft = std::numeric_limits<double>::infinity();
+            if (config.maxSeconds && !timedOut) {
+                secondsLeft = *config.maxSeconds - elapsed;
+                if (secondsLeft <= 0.0) {
+                    timedOut = true;
+                    abortRequested.store(true, std::memory_order_relaxed);
+                    stopRequested.store(true, std::memory_order_relaxed);
+                    secondsLeft = std::numeric_limits<double>::infinity();
+                }
+            }
+            if (config.checkpointSeconds && elapsed - lastCheckpoint >= *config.checkpointSeconds) {
+                lastCheckpoint = elapsed;
+                checkpointDue = true;
+                stopRequested.store(true, std::memory_order_relaxed);
+            }
+
+            // With a precision target, the games needed so far: interval widths shrink as 1/sqrt(games)
+            Tally::Totals running = tally.merge();
+            long long goalGames = runGames;
+            double widest = 1.0;
+            if (precision && running.games > 0) {
+                widest = precision->widest(running);
+                const double ratio = widest / precision->target().halfWidth;
+                const double needed = std::min(static_cast<double>(running.games) * ratio * ratio, static_cast<double>(runGames));
+                goalGames = std::max(static_cast<long long>(needed), currentGamesRun);
             }
 
             auto now = high_resolution_clock::now();
@@ -241,13 +1055,13 @@ int main(int argc, char* argv[]) {
             double totalElapsedSeconds = elapsedSinceStart.count();
 
             if (totalElapsedSeconds > 0.5) { // Start calculating after a short delay
-                simsPerSecond = static_cast<double>(currentGamesRun) / totalElapsedSeconds;
+                simsPerSecond = static_cast<double>(currentGamesRun - resumedGames) / totalElapsedSeconds;
             }
 
             // Calculate ETR
             std::string etrString = "Calculating...";
             if (simsPerSecond > 0.1) { // Avoid ETR calculation if rate is too low/unstable
-                long long remainingGames = totalSimulations - currentGamesRun;
+                long long remainingGames = goalGames - currentGamesRun;
                 double etrSeconds = static_cast<double>(remainingGames) / simsPerSecond;
 
                 if (etrSeconds >= 0) {
@@ -264,7 +1078,7 @@ int main(int argc, char* argv[]) {
             }
 
             // Calculate overall progress
-            double progress = static_cast<double>(currentGamesRun) / totalSimulations;
+            double progress = goalGames > 0 ? static_cast<double>(currentGamesRun) / goalGames : 1.0;
             int pos = static_cast<int>(barWidth * progress);
 
             // --- Display ---
@@ -280,7 +1094,11 @@ int main(int argc, char* argv[]) {
             }
             std::cout << "] " << static_cast<int>(progress * 100.0) << "% " << std::flush;
             std::cout << "(" << Helpers::formatWithCommas(currentGamesRun) << "/"
-                << Helpers::formatWithCommas(totalSimulations) << ")\n" << std::flush;
+                << Helpers::formatWithCommas(goalGames) << ")\n" << std::flush;
+            if (precision) {
+                std::cout << std::fixed << std::setprecision(3) << "Widest interval: +/-" << widest * 100.0
+                          << "% (target +/-" << precision->target().halfWidth * 100.0 << "%)\n" << std::flush;
+            }
 
             // Stats
             std::cout << std::fixed << std::setprecision(1); // For sims/sec formatting
@@ -290,29 +1108,155 @@ int main(int argc, char* argv[]) {
 
             // Live Strategy Wins
             std::cout << "Current Wins by Strategy:\n" << std::flush;
-            std::cout << "  Steal From Highest:         " << Helpers::formatWithCommas(winsStealFromHighest.load(std::memory_order_relaxed)) << "\n" << std::flush;
-            std::cout << "  Steal From Lowest:          " << Helpers::formatWithCommas(winsStealFromLowest.load(std::memory_order_relaxed)) << "\n" << std::flush;
-            std::cout << "  Steal From Opposite:        " << Helpers::formatWithCommas(winsStealFromOpposite.load(std::memory_order_relaxed)) << "\n" << std::flush;
-            std::cout << "  Steal Opposite Conditional: " << Helpers::formatWithCommas(winsStealOppositeConditional.load(std::memory_order_relaxed)) << "\n" << std::flush;
+            std::cout << "  Steal From Highest:         " << Helpers::formatWithCommas(running.strategyWins[Player::PlayStyle::StealFromHighest]) << "\n" << std::flush;
+            std::cout << "  Steal From Lowest:          " << Helpers::formatWithCommas(running.strategyWins[Player::PlayStyle::StealFromLowest]) << "\n" << std::flush;
+            std::cout << "  Steal From Opposite:        " << Helpers::formatWithCommas(running.strategyWins[Player::PlayStyle::StealFromOpposite]) << "\n" << std::flush;
+            std::cout << "  Steal Opposite Conditional: " << Helpers::formatWithCommas(running.strategyWins[Player::PlayStyle::StealOppositeConditional]) << "\n" << std::flush;
 
-            // Update interval
-            std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Update 5 times/sec
+            // Update interval: 5 times/sec, or sooner if the time budget runs out first
+            std::this_thread::sleep_for(std::min<duration<double>>(milliseconds(200), duration<double>(secondsLeft)));
         }
 
-        // --- Final 100% display ---
+        // --- Final display: full unless the time budget or a signal cut the run short ---
+        const long long finalGamesRun = totalGamesRun.load(std::memory_order_relaxed);
+        const bool stoppedEarly = timedOut || stopSignal != 0;
+        const long long plannedGames = stoppedEarly ? runGames : finalGamesRun;
+        const double finalProgress = plannedGames > 0 ? static_cast<double>(finalGamesRun) / plannedGames : 1.0;
         std::cout << "\033[H\033[J";
         std::cout << "Overall Progress: [" << std::flush;
         for (int i = 0; i < barWidth; ++i) {
-            std::cout << "=" << std::flush;
+            std::cout << (i < static_cast<int>(barWidth * finalProgress) ? "=" : " ") << std::flush;
         }
-        std::cout << "] 100% (" << Helpers::formatWithCommas(totalGamesRun.load(std::memory_order_relaxed)) << "/" << totalSimulations << ")\n" << std::flush;
+        std::cout << "] " << static_cast<int>(finalProgress * 100.0) << "% (" << Helpers::formatWithCommas(finalGamesRun) << "/"
+                  << Helpers::formatWithCommas(plannedGames) << ")" << (stoppedEarly ? " - stopped early" : "") << "\n" << std::flush;
 
         std::cout.flush();
     });
 
-    // Wait for all tasks to complete
-    while(totalGamesRun < totalSimulations) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Run every game on the pool. Workers claim contiguous ranges of game ids, and game ids
+    // are fixed by position in the run (batch i, replay j -> i * runEachSim + j), so each
+    // game's stream does not depend on scheduling.
+    // Chunks are sized to the range being played, about 32 per worker.
+    auto chunkSize = [&](int64_t first, int64_t last) {
+        return std::clamp<int64_t>((last - first) / (static_cast<int64_t>(maxThreads) * 32), 1, 4096);
+    };
+    // An abort cuts chunks short at a game boundary, so each chunk counts the games it finished.
+    const bool tracking = checkpointing || shard.has_value(); // Whether the finished ranges are recorded
+    std::vector<std::vector<Checkpoint::Range>> finishedRanges(maxThreads); // Per worker, when tracking
+    auto playChunk = [&](int64_t first, int64_t last) {
+        int64_t finished = last; // Games [first, finished) were played
+        try {
+            RoundStats::Accumulator* accumulator = roundStats ? &roundStats->worker(ThreadPool::currentWorker()) : nullptr;
+            if (config.engine == Config::Engine::Lockstep) {
+                // The engine interleaves the range's games across its lanes
+                thread_local LockstepEngine engine;
+                finished = engine.play(roster, seed, static_cast<int>(first), static_cast<int>(last),
+                            [&](int gameId) {
+                                int batch = batches.batchOf(gameId);
+                                return LockstepEngine::Deal{&batches.strategies(batch), batches.startSeat(batch)};
+                            },
+                            [&](const Result& result) {
+                                record(result);
+                            },
+                            accumulator, &abortRequested);
+            } else {
+                // Each worker keeps one table and re-deals it for every game
+                thread_local GameState state;
+                for (int gameId = static_cast<int>(first); gameId < last; ++gameId) {
+                    if (abortRequested.load(std::memory_order_relaxed)) {
+                        finished = gameId;
+                        break;
+                    }
+                    int batch = batches.batchOf(gameId);
+                    state.reset(roster, batches.strategies(batch), batches.startSeat(batch));
+                    Rng rng(seed, gameId);
+
+                    // Play the game and store the result
+                    Result result = specialized ? Kernels::play(gameId, state, rng, accumulator)
+                                                 : Game(state).play(gameId, rng, nullptr, accumulator);
+                    record(result);
+                }
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "Error during simulation: " << e.what() << std::endl;
+        }
+
+        // Games an error cut short still count as run so the progress display finishes
+        totalGamesRun.fetch_add(finished - first, std::memory_order_relaxed);
+        if (tracking) {
+            finishedRanges[ThreadPool::currentWorker()].emplace_back(first, finished);
+        }
+    };
+
+    // Without checkpoints the whole run is one pass. With them, the pool is paused for every
+    // checkpoint: once the workers have stopped, the counts and the finished ranges agree.
+    auto collectProgress = [&]() {
+        std::vector<Checkpoint::Range> ranges;
+        for (auto& worker : finishedRanges) {
+            ranges.insert(ranges.end(), worker.begin(), worker.end());
+            worker.clear();
+        }
+        checkpoint.addCompleted(std::move(ranges));
+        checkpoint.tally = tally.merge();
+        checkpoint.lengths = lengths.merge();
+        if (roundStats) checkpoint.rounds = roundStats->merge();
+    };
+    // The games up to checkEnd are played before the precision target is tested. A resumed run
+    // carries on from the first check it had not finished; every earlier one missed the target.
+    auto nextCheckEnd = [&](int64_t checkEnd) { return runBegin + Precision::nextCheck(checkEnd - runBegin, runGames); };
+    int64_t checkEnd = precision ? nextCheckEnd(runBegin) : runEnd;
+    while (checkEnd < runEnd && tracking && checkpoint.missing(runBegin, checkEnd).empty()) {
+        checkEnd = nextCheckEnd(checkEnd);
+    }
+    bool runComplete = false;
+    bool saveFailed = false;
+    try {
+        if (!tracking) {
+            int64_t first = runBegin;
+            while (true) {
+                pool.parallelFor(first, checkEnd, chunkSize(first, checkEnd), playChunk, stopRequested);
+                if (stopRequested.load() || checkEnd == runEnd) break;
+                if (precision->met(tally.merge())) {
+                    targetReached = true;
+                    break;
+                }
+                first = checkEnd;
+                checkEnd = nextCheckEnd(checkEnd);
+            }
+        } else {
+            while (true) {
+                for (const Checkpoint::Range& range : checkpoint.missing(runBegin, checkEnd)) {
+                    pool.parallelFor(range.first, range.second, chunkSize(range.first, range.second), playChunk, stopRequested);
+                    if (stopRequested.load()) break;
+                }
+                const bool paused = checkpointDue.exchange(false);
+                collectProgress();
+                // The target is tested before saving, so a saved run has missed every check it finished
+                const bool checkFinished = checkEnd < runEnd && checkpoint.missing(runBegin, checkEnd).empty();
+                if (checkFinished) {
+                    if (precision->met(checkpoint.tally)) targetReached = true;
+                    else checkEnd = nextCheckEnd(checkEnd);
+                }
+                if (checkpointing) checkpoint.save(checkpointFilename);
+                if (!(paused || checkFinished) || targetReached || abortRequested.load() || checkpoint.missing(runBegin, runEnd).empty()) break;
+                stopRequested = false;
+                if (abortRequested.load()) stopRequested = true; // A signal that arrived while saving
+            }
+            runComplete = targetReached || checkpoint.missing(runBegin, runEnd).empty();
+            if (runComplete && checkpointing) {
+                std::filesystem::remove(checkpointFilename);
+            }
+            if (shard) checkpoint.save(partialFilename);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Checkpoint error: " << e.what() << std::endl;
+        saveFailed = true;
+    }
+    runFinished = true;
+
+    // Flush the last per-game rows
+    if (sink) {
+        sink->close();
     }
 
     // Complete the progress bar
@@ -322,109 +1266,114 @@ int main(int argc, char* argv[]) {
 
     std::cout << std::endl;
 
-    std::sort(players.begin(), players.end(), [](const Player& a, const Player& b) {
-        return a.getIndex() < b.getIndex();
-    });
-
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsedSinceStart = end - start;
 
-    std::cout << "\nSimulations complete. " << Helpers::formatWithCommas(totalSimulations) << " simulations ran in " << elapsedSinceStart.count() << "s" << std::endl;
+    const int64_t gamesRun = totalGamesRun.load();
+    const bool stoppedEarly = stopSignal != 0 || timedOut;
+    std::cout << (stoppedEarly ? "\nSimulations stopped. " : "\nSimulations complete. ")
+              << Helpers::formatWithCommas(gamesRun) << " simulations ran in " << elapsedSinceStart.count() << "s" << std::endl;
+    if (stoppedEarly) {
+        std::cout << "Stopped early (";
+        if (timedOut) std::cout << "time budget of " << std::defaultfloat << std::setprecision(6) << *config.maxSeconds << "s reached";
+        else std::cout << (stopSignal == SIGINT ? "SIGINT" : "SIGTERM");
+        std::cout << "): results cover the " << Helpers::formatWithCommas(gamesRun) << " of "
+                  << Helpers::formatWithCommas(runGames) << " games that finished." << std::endl;
+    }
+    if (checkpointing && !runComplete) {
+        std::cout << "Progress saved to " << checkpointFilename << "; run again with --resume to continue. "
+                  << "Nothing is exported until the resumed run completes." << std::endl;
+    }
 
     // --- Display Results ---
-    std::cout << "\nWins by strategy (sorted by most to least):" << std::endl;
-
-    const int columnWidth = 30;
-    const int numberWidth = 8;
-
-    std::vector<std::pair<std::string, int>> strategyWins = {
-            {"Steal From Highest", winsStealFromHighest.load()},
-            {"Steal From Lowest", winsStealFromLowest.load()},
-            {"Steal From Opposite", winsStealFromOpposite.load()},
-            {"Steal Opposite Conditional", winsStealOppositeConditional.load()}
-    };
-
-    std::sort(strategyWins.begin(), strategyWins.end(), [](const auto& a, const auto& b) {
-        return b.second < a.second;
-    });
-
-    int totalWins = winsStealFromHighest + winsStealFromLowest + winsStealFromOpposite + winsStealOppositeConditional;
-    int totalGames = totalGamesRun.load();
-    int draws = totalGames - totalWins;
-
-    for (const auto& [strategy, wins] : strategyWins) {
-        double percentage = (totalWins > 0) ? (static_cast<double>(wins) / (totalWins + draws)) * 100.0 : 0.0;
-        std::cout << "  " << std::left << std::setw(columnWidth) << strategy
-                  << std::setw(numberWidth) << Helpers::formatWithCommas(wins) << " "
-                  << std::fixed << std::setprecision(2) << percentage << "%" << std::endl;
+    const Tally::Totals totals = tally.merge();
+    const std::vector<LengthHistogram::Series> lengthSeries = lengths.merge();
+    printSummary(totals, players, lengthSeries, precision.get(), totalSimulations);
+
+    // Only present in builds with LCR_ENABLE_EVENT_COUNTERS
+    if constexpr (EventCounters::Enabled) {
+        const int columnWidth = 30;
+        const EventCounters::Block events = EventCounters::merge();
+        const Player::PlayStyle styles[] = {Player::PlayStyle::StealFromHighest, Player::PlayStyle::StealFromLowest,
+                                            Player::PlayStyle::StealFromOpposite, Player::PlayStyle::StealOppositeConditional};
+        std::cout << "\nGame events by the strategy of the player rolling:" << std::endl;
+        std::cout << "  " << std::left << std::setw(columnWidth) << "" << std::right
+                  << std::setw(16) << "Highest" << std::setw(16) << "Lowest"
+                  << std::setw(16) << "Opposite" << std::setw(16) << "Opp. Cond." << std::endl;
+        for (int event = 0; event < EventCounters::NumEvents; ++event) {
+            std::cout << "  " << std::left << std::setw(columnWidth)
+                      << EventCounters::eventName(static_cast<EventCounters::Event>(event)) << std::right;
+            for (Player::PlayStyle style : styles) {
+                std::cout << std::setw(16) << Helpers::formatWithCommas(static_cast<long long>(events.counts[style][event]));
+            }
+            std::cout << std::endl;
+        }
     }
 
-    double drawPercentage = (totalGames > 0) ? (static_cast<double>(draws) / totalGames) * 100.0 : 0.0;
-    std::cout << "  " << std::left << std::setw(columnWidth) << "Draws"
-              << std::setw(numberWidth) << Helpers::formatWithCommas(draws) << " "
-              << std::fixed << std::setprecision(2) << drawPercentage << "%" << std::endl;
-
-    std::cout << "\nWins by player:" << std::endl;
-    for (const Player& player : players) {
-        double winPercentage = (totalWins > 0) ? (static_cast<double>(player.getWins()) / totalGames) * 100.0 : 0.0;
-        std::cout << "  " << std::left << std::setw(columnWidth) << player.getName()
-                  << std::setw(numberWidth) << Helpers::formatWithCommas(player.getWins()) << " ("
-                  << Player::playStyleToString(player.getPlayStyle()) << ") "
-                  << std::setprecision(2) << winPercentage << "%" << std::endl;
+    if (saveFailed) {
+        return 1;
+    }
+    if (shard) {
+        std::cout << "Partial results saved to " << partialFilename << "; combine the shards with `lcr merge`." << std::endl;
+        return stopSignal != 0 ? 128 + stopSignal : 0;
+    }
+    // The resumed run exports the whole run; a Totals row for this part would count its games twice
+    if (checkpointing && !runComplete) {
+        return stopSignal != 0 ? 128 + stopSignal : 0;
     }
 
     // --- Export Results to CSV ---
-    std::string outputFilename = "lcr_simulation_results.csv";
     try {
-        std::cout << "Exporting results to CSV..." << std::endl;
-
-        bool writeHeader = false;
-        if (!std::filesystem::exists(outputFilename)) {
-            writeHeader = true;
-        }
-
-        std::ofstream outFile(outputFilename, std::ios::app);
-
-        if (!outFile.is_open()) {
-            throw std::runtime_error("Could not open file for writing: " + outputFilename);
-        }
-
         switch (outputType) {
             case Output::OutputType::All:
-                if (writeHeader) {
-                    outFile << "gameId,winnerName,winnerStrategy,numberOfRounds,numberOfPlayers,initialChipsPerPlayer" << std::endl;
-                }
-
-                for (const Result& result : allResults) {
-                    outFile << result.gameId << ","
-                            << result.winnerName << ","
-                            << Player::playStyleToString(result.winnerStrategy) << ","
-                            << result.numberOfRounds << ","
-                            << result.numberOfPlayers << ","
-                            << result.initialChipsPerPlayer
-                            << std::endl;
-                }
+            case Output::OutputType::Binary:
+                // Records were written as the games finished
                 break;
             case Output::OutputType::Totals:
-                if (writeHeader) {
-                    outFile << "Highest,Lowest,Opposite, Opposite Conditional" << std::endl;
+                std::cout << "Exporting results to CSV..." << std::endl;
+                if (checkpointing) {
+                    writeHeader = !std::filesystem::exists(outputFilename);
+                    outFile.open(outputFilename, std::ios::app);
                 }
-
-                outFile << winsStealFromHighest << ","
-                        << winsStealFromLowest << ","
-                        << winsStealFromOpposite << ","
-                        << winsStealOppositeConditional
-                        << std::endl;
+                writeTotalsRow(outFile, totals, writeHeader);
                 break;
         }
 
         outFile.close();
-        std::cout << "Results successfully exported to CSV." << std::endl;
+        if (outFile.fail()) {
+            throw std::runtime_error("Could not write to " + outputFilename);
+        }
+        std::cout << "Results successfully exported to " << outputFilename << "." << std::endl;
+
+        if (config.jsonOutput) {
+            jsonFile.close();
+            if (jsonFile.fail()) {
+                throw std::runtime_error("Could not write to " + jsonFilename);
+            }
+            std::cout << "Per-game results exported to " << jsonFilename << "." << std::endl;
+        }
+
+        if (config.lengthHistogram) {
+            const std::string histogramFilename = "lcr_length_histogram.csv";
+            if (!exportLengthHistogram(lengthSeries, histogramFilename)) {
+                throw std::runtime_error("Could not write to " + histogramFilename);
+            }
+            std::cout << "Game-length histogram exported to " << histogramFilename << "." << std::endl;
+        }
+
+        if (roundStats) {
+            const std::string heatmapFilename = "lcr_round_heatmap.json";
+            if (!exportRoundHeatmap(roundStats->merge(), roster, heatmapFilename)) {
+                throw std::runtime_error("Could not write to " + heatmapFilename);
+            }
+            std::cout << "Round heatmap exported to " << heatmapFilename << "." << std::endl;
+        }
 
     } catch (const std::exception& e) {
         std::cerr << "File I/O Error: " << e.what() << std::endl;
         return 1;
     }
 
-    return 0;
+    // Interrupted runs exit as the shell reports a process killed by the signal, after exporting
+    return stopSignal != 0 ? 128 + stopSignal : 0;
 }
\ No newline at end of file
@@ -4,19 +4,43 @@ import numpy as np
 import seaborn as sns
 import sys
 
+# `python visualize_heatmap.py --rounds` plots the mean chips per seat per round over the
+# whole run (written when "roundHeatmap" is set in the config)
+if len(sys.argv) > 1 and sys.argv[1] == '--rounds':
+    with open('build/lcr_round_heatmap.json', 'r') as f:
+        heatmap = json.load(f)
+
+    plt.figure(figsize=(12, 8))
+    sns.heatmap(
+        np.array(heatmap['mean']).T,  # Players as rows, rounds as columns
+        cmap='YlOrRd',
+        cbar_kws={'label': 'Mean chips'},
+        xticklabels=heatmap['rounds'],
+        yticklabels=heatmap['seats']
+    )
+
+    plt.title(f"Mean Chips per Round - {heatmap['games'][0]} games")
+    plt.xlabel("Round")
+    plt.ylabel("Player")
+    plt.tight_layout()
+    plt.savefig("heatmap_rounds.png")
+    plt.show()
+    exit(0)
+
 # Load the JSON data
 with open('build/lcr_simulation_results.json', 'r') as f:
     data = json.load(f)
 
-# Select a game to visualize (e.g., the first game)
-game_index = int(sys.argv[1]) if len(sys.argv) > 1 else 0
-game = data[game_index]
-
-# Check if chipHistory exists
-if 'chipHistory' not in game:
+# Only games picked by "recordHistory" in the config carry a chip history
+recorded = [game for game in data if 'chipHistory' in game]
+if not recorded:
     print("No chip history found in the data")
     exit(1)
 
+# Select a recorded game to visualize (e.g., the first one)
+game_index = int(sys.argv[1]) if len(sys.argv) > 1 else 0
+game = recorded[game_index]
+
 # Extract chip history
 chip_history = np.array(game['chipHistory'])
 